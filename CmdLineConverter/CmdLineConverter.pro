@@ -66,7 +66,10 @@ unix:QMAKE_CXXFLAGS += -fno-strict-aliasing
 unix:QMAKE_CFLAGS += -fno-strict-aliasing
 
 # Input
-HEADERS += DebugOut/HRConsoleOut.h
+HEADERS += DebugOut/HRConsoleOut.h \
+           UVFExpression.h \
+           UVFMerge.h \
+           UVFRebrick.h
 
 
 SOURCES += DebugOut/HRConsoleOut.cpp \
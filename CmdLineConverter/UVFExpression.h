@@ -0,0 +1,618 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2013 Interactive Visualization and Data Analysis Group
+
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+/**
+  \file    UVFExpression.h
+  \brief   Compiles a merge expression over the input volumes into a program
+           of batch operations and evaluates it in one streaming pass over
+           the bricks of all inputs.
+*/
+
+#pragma once
+
+#ifndef UVFEXPRESSION_H
+#define UVFEXPRESSION_H
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "UVFMerge.h"
+
+// voxels every instruction of an expression program processes at once
+static const size_t EXPRESSION_BATCH = 1024;
+
+enum ExpressionOpcode {
+  EO_ADD,
+  EO_SUBTRACT,
+  EO_MULTIPLY,
+  EO_DIVIDE,
+  EO_MIN,
+  EO_MAX,
+  EO_LESS,
+  EO_LESS_EQUAL,
+  EO_GREATER,
+  EO_GREATER_EQUAL,
+  EO_EQUAL,
+  EO_NOT_EQUAL,
+  EO_AND,
+  EO_OR,
+  EO_NEGATE,
+  EO_NOT,
+  EO_ABS,
+  EO_SQRT,
+  EO_SELECT
+};
+
+// Applies eOp to iCount values of the operands a, b and c, as far as the
+// operation has them. Comparisons and logic yield 1 for true and 0 for
+// false, every case is a plain loop without branches the compiler can
+// vectorize. r may be the same as one of the operands.
+static void ApplyOperation(ExpressionOpcode eOp, size_t iCount, double* r,
+                           const double* a, const double* b,
+                           const double* c) {
+  switch (eOp) {
+#define BATCH_OPERATION(OP, EXPR)                                           \
+    case OP :                                                               \
+      for (size_t i = 0;i<iCount;i++) r[i] = (EXPR);                        \
+      break;
+    BATCH_OPERATION(EO_ADD,           a[i] + b[i])
+    BATCH_OPERATION(EO_SUBTRACT,      a[i] - b[i])
+    BATCH_OPERATION(EO_MULTIPLY,      a[i] * b[i])
+    BATCH_OPERATION(EO_DIVIDE,        a[i] / b[i])
+    BATCH_OPERATION(EO_MIN,           a[i] < b[i] ? a[i] : b[i])
+    BATCH_OPERATION(EO_MAX,           a[i] > b[i] ? a[i] : b[i])
+    BATCH_OPERATION(EO_LESS,          a[i] <  b[i] ? 1.0 : 0.0)
+    BATCH_OPERATION(EO_LESS_EQUAL,    a[i] <= b[i] ? 1.0 : 0.0)
+    BATCH_OPERATION(EO_GREATER,       a[i] >  b[i] ? 1.0 : 0.0)
+    BATCH_OPERATION(EO_GREATER_EQUAL, a[i] >= b[i] ? 1.0 : 0.0)
+    BATCH_OPERATION(EO_EQUAL,         a[i] == b[i] ? 1.0 : 0.0)
+    BATCH_OPERATION(EO_NOT_EQUAL,     a[i] != b[i] ? 1.0 : 0.0)
+    BATCH_OPERATION(EO_AND, (a[i] != 0.0) & (b[i] != 0.0) ? 1.0 : 0.0)
+    BATCH_OPERATION(EO_OR,  (a[i] != 0.0) | (b[i] != 0.0) ? 1.0 : 0.0)
+    BATCH_OPERATION(EO_NEGATE,        -a[i])
+    BATCH_OPERATION(EO_NOT,           a[i] == 0.0 ? 1.0 : 0.0)
+    BATCH_OPERATION(EO_ABS,           std::fabs(a[i]))
+    BATCH_OPERATION(EO_SQRT,          std::sqrt(a[i]))
+    BATCH_OPERATION(EO_SELECT,        a[i] != 0.0 ? b[i] : c[i])
+#undef BATCH_OPERATION
+  }
+}
+
+// Converts iCount values, starting at value iFirst, to double.
+template<typename T>
+static void ConvertValues(const uint8_t* pData, size_t iFirst,
+                          size_t iCount, double* pTarget) {
+  const T* pValues = reinterpret_cast<const T*>(pData) + iFirst;
+  for (size_t i = 0;i<iCount;i++) pTarget[i] = double(pValues[i]);
+}
+
+static void ConvertValues(ExtendedOctree::COMPONENT_TYPE eType,
+                          const uint8_t* pData, size_t iFirst,
+                          size_t iCount, double* pTarget) {
+  switch (eType) {
+#define CONVERT_VALUES(CT, T)                                               \
+    case ExtendedOctree::CT :                                               \
+      ConvertValues<T>(pData, iFirst, iCount, pTarget);                     \
+      break;
+    CONVERT_VALUES(CT_UINT8,   uint8_t)
+    CONVERT_VALUES(CT_INT8,    int8_t)
+    CONVERT_VALUES(CT_UINT16,  uint16_t)
+    CONVERT_VALUES(CT_INT16,   int16_t)
+    CONVERT_VALUES(CT_UINT32,  uint32_t)
+    CONVERT_VALUES(CT_INT32,   int32_t)
+    CONVERT_VALUES(CT_UINT64,  uint64_t)
+    CONVERT_VALUES(CT_INT64,   int64_t)
+    CONVERT_VALUES(CT_FLOAT32, float)
+    CONVERT_VALUES(CT_FLOAT64, double)
+#undef CONVERT_VALUES
+  }
+}
+
+struct ExpressionNode {
+  enum KIND {
+    EN_CONSTANT,
+    EN_INPUT,
+    EN_OPERATION
+  };
+
+  KIND                                         eKind;
+  double                                       fValue;
+  size_t                                       iInput;
+  ExpressionOpcode                             eOp;
+  std::vector<std::shared_ptr<ExpressionNode>> vOperands;
+  size_t                                       iRegister;
+};
+typedef std::shared_ptr<ExpressionNode> ExpressionNode_ptr;
+
+// Recursive descent parser for expressions such as
+//   v[0] > 100 ? max(v[1], v[2]) : 0.5 * (v[1] + v[2])
+// with v[i] the i-th input volume, the arithmetic, comparison and logic
+// operators of C, the conditional operator and the functions min, max,
+// abs and sqrt. Operations on constants only are folded while parsing.
+class ExpressionParser {
+public:
+  ExpressionParser(const std::string& strExpression, size_t iInputs) :
+    m_strExpression(strExpression),
+    m_iPos(0),
+    m_iInputs(iInputs)
+  {}
+
+  // the syntax tree of the whole expression, NULL if it cannot be parsed
+  ExpressionNode_ptr Parse() {
+    ExpressionNode_ptr node = Conditional();
+    if (node && !AtEnd()) return Fail("unexpected input");
+    return node;
+  }
+
+  const std::string& Problem() const { return m_strProblem; }
+
+private:
+  const std::string& m_strExpression;
+  size_t             m_iPos;
+  size_t             m_iInputs;
+  std::string        m_strProblem;
+
+  ExpressionNode_ptr Fail(const std::string& strProblem) {
+    if (m_strProblem.empty())
+      m_strProblem = strProblem + " at position " +
+                     SysTools::ToString(m_iPos + 1);
+    return ExpressionNode_ptr();
+  }
+
+  void SkipSpace() {
+    while (m_iPos < m_strExpression.size() &&
+           isspace((unsigned char)m_strExpression[m_iPos]))
+      m_iPos++;
+  }
+
+  bool AtEnd() {
+    SkipSpace();
+    return m_iPos == m_strExpression.size();
+  }
+
+  // consumes strToken if the input continues with it, but no operator
+  // that starts with it
+  bool Accept(const char* strToken) {
+    SkipSpace();
+    const size_t iLength = strlen(strToken);
+    if (m_strExpression.compare(m_iPos, iLength, strToken) != 0)
+      return false;
+    const char next = m_iPos + iLength < m_strExpression.size()
+                      ? m_strExpression[m_iPos + iLength] : '\0';
+    if (iLength == 1 && strchr("<>=!", strToken[0]) && next == '=')
+      return false;
+    if (iLength == 1 && strchr("&|", strToken[0]) && next == strToken[0])
+      return false;
+    m_iPos += iLength;
+    return true;
+  }
+
+  static ExpressionNode_ptr Constant(double fValue) {
+    ExpressionNode_ptr node(new ExpressionNode());
+    node->eKind = ExpressionNode::EN_CONSTANT;
+    node->fValue = fValue;
+    return node;
+  }
+
+  static ExpressionNode_ptr Operation(ExpressionOpcode eOp,
+                                      ExpressionNode_ptr a,
+                                      ExpressionNode_ptr b =
+                                        ExpressionNode_ptr(),
+                                      ExpressionNode_ptr c =
+                                        ExpressionNode_ptr()) {
+    if (!a) return a;
+    ExpressionNode_ptr node(new ExpressionNode());
+    node->eKind = ExpressionNode::EN_OPERATION;
+    node->eOp = eOp;
+    bool bConstant = true;
+    const ExpressionNode_ptr operands[3] = {a, b, c};
+    for (size_t i = 0;i<3 && operands[i];i++) {
+      node->vOperands.push_back(operands[i]);
+      bConstant &= operands[i]->eKind == ExpressionNode::EN_CONSTANT;
+    }
+    if (!bConstant) return node;
+
+    double values[3] = {0.0, 0.0, 0.0};
+    for (size_t i = 0;i<node->vOperands.size();i++)
+      values[i] = node->vOperands[i]->fValue;
+    double fResult;
+    ApplyOperation(eOp, 1, &fResult, &values[0], &values[1], &values[2]);
+    return Constant(fResult);
+  }
+
+  // conditional := or ('?' conditional ':' conditional)?
+  ExpressionNode_ptr Conditional() {
+    ExpressionNode_ptr condition = Or();
+    if (!condition || !Accept("?")) return condition;
+    ExpressionNode_ptr a = Conditional();
+    if (!a) return a;
+    if (!Accept(":")) return Fail("expected ':'");
+    ExpressionNode_ptr b = Conditional();
+    if (!b) return b;
+    return Operation(EO_SELECT, condition, a, b);
+  }
+
+  // or := and ('||' and)*
+  ExpressionNode_ptr Or() {
+    ExpressionNode_ptr node = And();
+    while (node && Accept("||")) {
+      ExpressionNode_ptr b = And();
+      if (!b) return b;
+      node = Operation(EO_OR, node, b);
+    }
+    return node;
+  }
+
+  // and := equality ('&&' equality)*
+  ExpressionNode_ptr And() {
+    ExpressionNode_ptr node = Equality();
+    while (node && Accept("&&")) {
+      ExpressionNode_ptr b = Equality();
+      if (!b) return b;
+      node = Operation(EO_AND, node, b);
+    }
+    return node;
+  }
+
+  // equality := relational (('==' | '!=') relational)*, binds less tightly
+  // than the relational operators as in C
+  ExpressionNode_ptr Equality() {
+    ExpressionNode_ptr node = Relational();
+    while (node) {
+      ExpressionOpcode eOp;
+      if (Accept("==")) eOp = EO_EQUAL;
+      else if (Accept("!=")) eOp = EO_NOT_EQUAL;
+      else break;
+      ExpressionNode_ptr b = Relational();
+      if (!b) return b;
+      node = Operation(eOp, node, b);
+    }
+    return node;
+  }
+
+  // relational := sum (('<' | '<=' | '>' | '>=') sum)*
+  ExpressionNode_ptr Relational() {
+    static const char* strTokens[] = {"<=", ">=", "<", ">"};
+    static const ExpressionOpcode eOps[] = {
+      EO_LESS_EQUAL, EO_GREATER_EQUAL, EO_LESS, EO_GREATER
+    };
+    ExpressionNode_ptr node = Sum();
+    while (node) {
+      size_t i = 0;
+      while (i<4 && !Accept(strTokens[i])) i++;
+      if (i == 4) break;
+      ExpressionNode_ptr b = Sum();
+      if (!b) return b;
+      node = Operation(eOps[i], node, b);
+    }
+    return node;
+  }
+
+  // sum := product (('+' | '-') product)*
+  ExpressionNode_ptr Sum() {
+    ExpressionNode_ptr node = Product();
+    while (node) {
+      ExpressionOpcode eOp;
+      if (Accept("+")) eOp = EO_ADD;
+      else if (Accept("-")) eOp = EO_SUBTRACT;
+      else break;
+      ExpressionNode_ptr b = Product();
+      if (!b) return b;
+      node = Operation(eOp, node, b);
+    }
+    return node;
+  }
+
+  // product := unary (('*' | '/') unary)*
+  ExpressionNode_ptr Product() {
+    ExpressionNode_ptr node = Unary();
+    while (node) {
+      ExpressionOpcode eOp;
+      if (Accept("*")) eOp = EO_MULTIPLY;
+      else if (Accept("/")) eOp = EO_DIVIDE;
+      else break;
+      ExpressionNode_ptr b = Unary();
+      if (!b) return b;
+      node = Operation(eOp, node, b);
+    }
+    return node;
+  }
+
+  // unary := ('-' | '+' | '!') unary | primary
+  ExpressionNode_ptr Unary() {
+    if (Accept("-")) return Operation(EO_NEGATE, Unary());
+    if (Accept("+")) return Unary();
+    if (Accept("!")) return Operation(EO_NOT, Unary());
+    return Primary();
+  }
+
+  // primary := number | 'v' '[' integer ']' | function '(' arguments ')'
+  //          | '(' conditional ')'
+  ExpressionNode_ptr Primary() {
+    SkipSpace();
+    if (AtEnd()) return Fail("unexpected end");
+
+    if (Accept("(")) {
+      ExpressionNode_ptr node = Conditional();
+      if (node && !Accept(")")) return Fail("expected ')'");
+      return node;
+    }
+
+    const char* pStart = m_strExpression.c_str() + m_iPos;
+    if (isdigit((unsigned char)*pStart) || *pStart == '.') {
+      char* pEnd;
+      const double fValue = strtod(pStart, &pEnd);
+      if (pEnd == pStart) return Fail("invalid number");
+      m_iPos += size_t(pEnd - pStart);
+      return Constant(fValue);
+    }
+
+    size_t iEnd = m_iPos;
+    while (iEnd < m_strExpression.size() &&
+           (isalnum((unsigned char)m_strExpression[iEnd]) ||
+            m_strExpression[iEnd] == '_'))
+      iEnd++;
+    const std::string strName = m_strExpression.substr(m_iPos, iEnd-m_iPos);
+    if (strName.empty()) return Fail("unexpected character");
+    m_iPos = iEnd;
+
+    if (strName == "v") {
+      if (!Accept("[")) return Fail("expected '['");
+      SkipSpace();
+      const char* pIndex = m_strExpression.c_str() + m_iPos;
+      char* pEnd;
+      const unsigned long iInput = strtoul(pIndex, &pEnd, 10);
+      if (pEnd == pIndex) return Fail("expected a volume index");
+      m_iPos += size_t(pEnd - pIndex);
+      if (iInput >= m_iInputs)
+        return Fail("v[" + SysTools::ToString(iInput) + "] but only " +
+                    SysTools::ToString(m_iInputs) + " input volumes");
+      if (!Accept("]")) return Fail("expected ']'");
+      ExpressionNode_ptr node(new ExpressionNode());
+      node->eKind = ExpressionNode::EN_INPUT;
+      node->iInput = size_t(iInput);
+      return node;
+    }
+
+    ExpressionOpcode eOp;
+    size_t iArguments = 2;
+    if (strName == "min") eOp = EO_MIN;
+    else if (strName == "max") eOp = EO_MAX;
+    else if (strName == "abs") { eOp = EO_ABS; iArguments = 1; }
+    else if (strName == "sqrt") { eOp = EO_SQRT; iArguments = 1; }
+    else return Fail("unknown name '" + strName + "'");
+
+    if (!Accept("(")) return Fail("expected '('");
+    ExpressionNode_ptr a = Conditional();
+    if (!a) return a;
+    ExpressionNode_ptr b;
+    if (iArguments == 2) {
+      if (!Accept(",")) return Fail("expected ','");
+      b = Conditional();
+      if (!b) return b;
+    }
+    if (!Accept(")")) return Fail("expected ')'");
+    return Operation(eOp, a, b);
+  }
+};
+
+// An expression compiled into a sequence of batch operations on registers
+// of EXPRESSION_BATCH doubles. Registers 0 to iInputs-1 hold the input
+// values, followed by one register per constant and the temporaries, which
+// are reused as in a stack machine.
+class ExpressionProgram {
+public:
+  ExpressionProgram() : m_iRegisters(0), m_iResult(0) {}
+
+  // false if the expression cannot be parsed, strProblem says why
+  bool Compile(const std::string& strExpression, size_t iInputs,
+               std::string& strProblem) {
+    ExpressionParser parser(strExpression, iInputs);
+    const ExpressionNode_ptr root = parser.Parse();
+    if (!root) {
+      strProblem = parser.Problem();
+      return false;
+    }
+    m_vCode.clear();
+    m_vConstants.clear();
+    m_vInputUsed.assign(iInputs, false);
+    AssignConstants(*root, iInputs);
+    m_iRegisters = iInputs + m_vConstants.size();
+    m_iResult = Emit(*root, m_iRegisters);
+    m_iRegisters = std::max(m_iRegisters, m_iResult + 1);
+    return true;
+  }
+
+  bool InputUsed(size_t i) const { return m_vInputUsed[i]; }
+  size_t InputRegister(size_t i) const { return i; }
+  size_t ResultRegister() const { return m_iResult; }
+
+  // registers for one thread, with the constants in place
+  std::vector<double> CreateRegisters() const {
+    std::vector<double> vRegisters(m_iRegisters * EXPRESSION_BATCH);
+    for (size_t i = 0;i<m_vConstants.size();i++)
+      std::fill(Register(vRegisters, m_vConstants[i].first),
+                Register(vRegisters, m_vConstants[i].first) +
+                EXPRESSION_BATCH,
+                m_vConstants[i].second);
+    return vRegisters;
+  }
+
+  static double* Register(std::vector<double>& vRegisters, size_t i) {
+    return &vRegisters[i * EXPRESSION_BATCH];
+  }
+
+  // runs the program on the first iCount values of the registers
+  void Run(std::vector<double>& vRegisters, size_t iCount) const {
+    for (size_t i = 0;i<m_vCode.size();i++) {
+      const Instruction& instruction = m_vCode[i];
+      ApplyOperation(instruction.eOp, iCount,
+                     Register(vRegisters, instruction.iTarget),
+                     Register(vRegisters, instruction.iOperands[0]),
+                     Register(vRegisters, instruction.iOperands[1]),
+                     Register(vRegisters, instruction.iOperands[2]));
+    }
+  }
+
+private:
+  struct Instruction {
+    ExpressionOpcode eOp;
+    size_t           iTarget;
+    size_t           iOperands[3];
+  };
+
+  std::vector<Instruction>               m_vCode;
+  std::vector<std::pair<size_t, double>> m_vConstants;
+  std::vector<bool>                      m_vInputUsed;
+  size_t                                 m_iRegisters;
+  size_t                                 m_iResult;
+
+  void AssignConstants(ExpressionNode& node, size_t iInputs) {
+    if (node.eKind == ExpressionNode::EN_CONSTANT) {
+      node.iRegister = iInputs + m_vConstants.size();
+      m_vConstants.push_back(std::make_pair(node.iRegister, node.fValue));
+    }
+    for (size_t i = 0;i<node.vOperands.size();i++)
+      AssignConstants(*node.vOperands[i], iInputs);
+  }
+
+  // emits the code for node, temporaries start at iFree, returns the
+  // register of the result
+  size_t Emit(const ExpressionNode& node, size_t iFree) {
+    switch (node.eKind) {
+      case ExpressionNode::EN_CONSTANT :
+        return node.iRegister;
+      case ExpressionNode::EN_INPUT :
+        m_vInputUsed[node.iInput] = true;
+        return InputRegister(node.iInput);
+      default : {
+        Instruction instruction;
+        instruction.eOp = node.eOp;
+        instruction.iTarget = iFree;
+        size_t iNext = iFree;
+        for (size_t i = 0;i<3;i++) {
+          if (i < node.vOperands.size()) {
+            instruction.iOperands[i] = Emit(*node.vOperands[i], iNext);
+            // keep the result of this operand for the operation
+            if (instruction.iOperands[i] == iNext) iNext++;
+          } else {
+            instruction.iOperands[i] = instruction.iOperands[0];
+          }
+        }
+        m_vCode.push_back(instruction);
+        m_iRegisters = std::max(m_iRegisters, iNext);
+        m_iRegisters = std::max(m_iRegisters, iFree + 1);
+        return iFree;
+      }
+    }
+  }
+};
+
+// The expression evaluated for every voxel of the inputs, batch by batch.
+template<typename T>
+class ExpressionSourceFile : public CombinedSourceFile<T> {
+public:
+  ExpressionSourceFile(const std::string& strName,
+                       const std::vector<const TOCBlock*>& vInputs,
+                       const ExpressionProgram& program,
+                       uint64_t iInputCacheBytes, uint64_t iCacheBytes) :
+    CombinedSourceFile<T>(strName, vInputs, iInputCacheBytes, iCacheBytes),
+    m_Program(program)
+  {}
+
+protected:
+  virtual bool InputUsed(size_t i) const { return m_Program.InputUsed(i); }
+
+  virtual void CombineSlice(size_t z, size_t iVoxels,
+                            double* pResult) const {
+    std::vector<double> vRegisters = m_Program.CreateRegisters();
+    for (size_t iFirst = 0;iFirst<iVoxels;iFirst += EXPRESSION_BATCH) {
+      const size_t iCount = std::min(EXPRESSION_BATCH, iVoxels - iFirst);
+      for (size_t i = 0;i<this->m_vTypes.size();i++) {
+        if (!m_Program.InputUsed(i)) continue;
+        ConvertValues(this->m_vTypes[i], this->InputSlice(i, z, iVoxels),
+                      iFirst, iCount,
+                      ExpressionProgram::Register(
+                        vRegisters, m_Program.InputRegister(i)));
+      }
+      m_Program.Run(vRegisters, iCount);
+      const double* pValues =
+        ExpressionProgram::Register(vRegisters, m_Program.ResultRegister());
+      std::copy(pValues, pValues + iCount, pResult + iFirst);
+    }
+  }
+
+private:
+  ExpressionProgram m_Program;
+};
+
+// Evaluates strExpression for every voxel of the single component TOC
+// volumes of vSources and writes the result to strTarget, in one pass over
+// the bricks without intermediate files. bUnsupported is set if the
+// expression uses syntax the compiler does not know or one of the sources
+// does not have exactly one TOC volume, strTarget is not touched then.
+static bool EvaluateUVFs(const std::string& strExpression,
+                         const std::vector<std::string>& vSources,
+                         const std::string& strTarget,
+                         uint32_t iBrickSize, uint32_t iOverlap,
+                         uint32_t iCompression, uint32_t iCompressionLevel,
+                         uint32_t iLayout, uint64_t iMemory,
+                         bool& bUnsupported) {
+  ExpressionProgram program;
+  std::string strProblem;
+  if (!program.Compile(strExpression, vSources.size(), strProblem)) {
+    bUnsupported = true;
+    MESSAGE("The expression cannot be compiled (%s)", strProblem.c_str());
+    return false;
+  }
+
+  std::shared_ptr<KeyValuePairDataBlock> metaPairs(
+    new KeyValuePairDataBlock()
+  );
+  metaPairs->AddPair("Data Source", "Computed by the UVF converter");
+  metaPairs->AddPair("Expression", strExpression);
+  for (size_t i = 0;i<vSources.size();i++)
+    metaPairs->AddPair("Expression Input " + SysTools::ToString(i),
+                       vSources[i]);
+
+  MESSAGE("Evaluating the expression over %u volumes ...",
+          unsigned(vSources.size()));
+  return CombineUVFs<ExpressionSourceFile>(vSources, program,
+                                           "Expression Volume", metaPairs,
+                                           strTarget, iBrickSize, iOverlap,
+                                           iCompression, iCompressionLevel,
+                                           iLayout, iMemory, bUnsupported);
+}
+
+#endif // UVFEXPRESSION_H
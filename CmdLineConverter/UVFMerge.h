@@ -0,0 +1,525 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2013 Interactive Visualization and Data Analysis Group
+
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+  \file    UVFMerge.h
+  \brief   Merges the TOC volumes of any number of UVF files into a new UVF
+           file in one streaming pass over the bricks of all inputs.
+*/
+
+#pragma once
+
+#ifndef UVFMERGE_H
+#define UVFMERGE_H
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../Tuvok/StdTuvokDefines.h"
+#include "../Tuvok/Controller/Controller.h"
+#include "../Tuvok/Basics/SysTools.h"
+#include "../Tuvok/IO/UVF/UVF.h"
+#include "../Tuvok/IO/UVF/TOCBlock.h"
+#include "../Tuvok/IO/UVF/MaxMinDataBlock.h"
+#include "../Tuvok/IO/UVF/Histogram1DDataBlock.h"
+#include "../Tuvok/IO/UVF/Histogram2DDataBlock.h"
+#include "../Tuvok/IO/UVF/KeyValuePairDataBlock.h"
+
+#include "../UVFReader/HistogramTools.h"
+#include "../UVFReader/ParallelTools.h"
+#include "UVFRebrick.h"
+
+// Adds fScale * value + fBias of iCount values to pSum.
+template<typename T>
+static void AddScaledValues(const uint8_t* pData, size_t iCount,
+                            double fScale, double fBias, double* pSum) {
+  const T* pValues = reinterpret_cast<const T*>(pData);
+  for (size_t i = 0;i<iCount;i++)
+    pSum[i] += fScale * double(pValues[i]) + fBias;
+}
+
+static void AddScaledValues(ExtendedOctree::COMPONENT_TYPE eType,
+                            const uint8_t* pData, size_t iCount,
+                            double fScale, double fBias, double* pSum) {
+  switch (eType) {
+#define ADD_SCALED(CT, T)                                                   \
+    case ExtendedOctree::CT :                                               \
+      AddScaledValues<T>(pData, iCount, fScale, fBias, pSum);               \
+      break;
+    ADD_SCALED(CT_UINT8,   uint8_t)
+    ADD_SCALED(CT_INT8,    int8_t)
+    ADD_SCALED(CT_UINT16,  uint16_t)
+    ADD_SCALED(CT_INT16,   int16_t)
+    ADD_SCALED(CT_UINT32,  uint32_t)
+    ADD_SCALED(CT_INT32,   int32_t)
+    ADD_SCALED(CT_UINT64,  uint64_t)
+    ADD_SCALED(CT_INT64,   int64_t)
+    ADD_SCALED(CT_FLOAT32, float)
+    ADD_SCALED(CT_FLOAT64, double)
+#undef ADD_SCALED
+  }
+}
+
+static bool IsFloatType(ExtendedOctree::COMPONENT_TYPE eType) {
+  return eType == ExtendedOctree::CT_FLOAT32 ||
+         eType == ExtendedOctree::CT_FLOAT64;
+}
+
+static bool IsSignedType(ExtendedOctree::COMPONENT_TYPE eType) {
+  return eType == ExtendedOctree::CT_INT8 ||
+         eType == ExtendedOctree::CT_INT16 ||
+         eType == ExtendedOctree::CT_INT32 ||
+         eType == ExtendedOctree::CT_INT64 || IsFloatType(eType);
+}
+
+// Smallest and largest value of eType.
+static void ComponentTypeRange(ExtendedOctree::COMPONENT_TYPE eType,
+                               double& fMin, double& fMax) {
+  switch (eType) {
+#define TYPE_RANGE(CT, T)                                                   \
+    case ExtendedOctree::CT :                                               \
+      fMin = double(std::numeric_limits<T>::lowest());                      \
+      fMax = double(std::numeric_limits<T>::max());                         \
+      break;
+    TYPE_RANGE(CT_UINT8,   uint8_t)
+    TYPE_RANGE(CT_INT8,    int8_t)
+    TYPE_RANGE(CT_UINT16,  uint16_t)
+    TYPE_RANGE(CT_INT16,   int16_t)
+    TYPE_RANGE(CT_UINT32,  uint32_t)
+    TYPE_RANGE(CT_INT32,   int32_t)
+    TYPE_RANGE(CT_UINT64,  uint64_t)
+    TYPE_RANGE(CT_INT64,   int64_t)
+    TYPE_RANGE(CT_FLOAT32, float)
+    TYPE_RANGE(CT_FLOAT64, double)
+#undef TYPE_RANGE
+  }
+}
+
+// Smallest type that holds every value in [fMin, fMax]. Integer results
+// get the narrowest of the 8 to 32 bit integers that fits; ranges no 32
+// bit integer holds go to double, not to float, which would drop the low
+// bits of large values. Results with a float input are floats, doubles
+// if an input has 64 bits.
+static ExtendedOctree::COMPONENT_TYPE
+ComponentTypeForRange(double fMin, double fMax, bool bFloat, bool bWide) {
+  if (bWide) return ExtendedOctree::CT_FLOAT64;
+  if (bFloat) return ExtendedOctree::CT_FLOAT32;
+
+  static const ExtendedOctree::COMPONENT_TYPE eCandidates[] = {
+    ExtendedOctree::CT_UINT8,  ExtendedOctree::CT_INT8,
+    ExtendedOctree::CT_UINT16, ExtendedOctree::CT_INT16,
+    ExtendedOctree::CT_UINT32, ExtendedOctree::CT_INT32
+  };
+  for (size_t i = 0;i<sizeof(eCandidates)/sizeof(eCandidates[0]);i++) {
+    double fTypeMin, fTypeMax;
+    ComponentTypeRange(eCandidates[i], fTypeMin, fTypeMax);
+    if (fMin >= fTypeMin && fMax <= fTypeMax) return eCandidates[i];
+  }
+  return ExtendedOctree::CT_FLOAT64;
+}
+
+// Type of a volume computed from the inputs: one that holds every value of
+// every input, so mixing signed and unsigned inputs widens to the next
+// larger signed type. Sources that know the range of their result provide
+// an overload for their parameters.
+template<typename Parameters>
+static ExtendedOctree::COMPONENT_TYPE
+ResultComponentType(const Parameters&,
+                    const std::vector<const TOCBlock*>& vInputs) {
+  double fMin = 0.0, fMax = 0.0;
+  bool bFloat = false;
+  bool bWide = false;
+  for (size_t i = 0;i<vInputs.size();i++) {
+    const ExtendedOctree::COMPONENT_TYPE eType = vInputs[i]->GetComponentType();
+    double fTypeMin, fTypeMax;
+    ComponentTypeRange(eType, fTypeMin, fTypeMax);
+    fMin = std::min(fMin, fTypeMin);
+    fMax = std::max(fMax, fTypeMax);
+    bFloat |= IsFloatType(eType);
+    bWide |= vInputs[i]->GetComponentTypeSize() == 8;
+  }
+  return ComponentTypeForRange(fMin, fMax, bFloat, bWide);
+}
+
+// A volume computed voxel by voxel from the same region of several TOC
+// volumes, as the input of the bricker. The inputs of a block are read in
+// parallel, each through its own cache of decompressed bricks, derived
+// classes combine them slice-parallel into doubles which are then
+// converted to T. Both steps run on std::threads, the converter is not
+// built with OpenMP.
+template<typename T>
+class CombinedSourceFile : public BlockCacheFile {
+public:
+  CombinedSourceFile(const std::string& strName,
+                     const std::vector<const TOCBlock*>& vInputs,
+                     uint64_t iInputCacheBytes, uint64_t iCacheBytes) :
+    BlockCacheFile(strName, vInputs[0]->GetLODDomainSize(0), sizeof(T),
+                   UINT64VECTOR3(128, 128, 128), 0, iCacheBytes),
+    m_vInputData(vInputs.size())
+  {
+    for (size_t i = 0;i<vInputs.size();i++) {
+      m_vInputs.push_back(std::shared_ptr<TOCSourceFile>(
+        new TOCSourceFile(strName, vInputs[i], iInputCacheBytes)));
+      m_vTypes.push_back(vInputs[i]->GetComponentType());
+      m_vTypeSizes.push_back(vInputs[i]->GetComponentTypeSize());
+    }
+  }
+
+  virtual void Close() {
+    BlockCacheFile::Close();
+    for (size_t i = 0;i<m_vInputs.size();i++) m_vInputs[i]->Close();
+  }
+
+protected:
+  std::vector<ExtendedOctree::COMPONENT_TYPE>  m_vTypes;
+
+  // computes iVoxels values of the result from slice z of the current
+  // block, called concurrently for different slices
+  virtual void CombineSlice(size_t z, size_t iVoxels,
+                            double* pResult) const = 0;
+
+  // inputs the result does not depend on are not read
+  virtual bool InputUsed(size_t) const { return true; }
+
+  // slice z of input i in the current block
+  const uint8_t* InputSlice(size_t i, size_t z, size_t iVoxels) const {
+    return &m_vInputData[i][z * iVoxels * size_t(m_vTypeSizes[i])];
+  }
+
+  virtual void FillBlock(const UINT64VECTOR4& key, uint8_t* pData) {
+    const UINT64VECTOR3 vSize = BlockSize(key);
+    const UINT64VECTOR3 vOrigin(key.x * m_vInner.x, key.y * m_vInner.y,
+                                key.z * m_vInner.z);
+    const size_t iSliceVoxels = size_t(vSize.x * vSize.y);
+
+    // every input is read by one thread, reads of different TOC blocks
+    // do not interfere
+    ParallelFor(m_vInputs.size(), WorkerCount(), [&](size_t i) {
+      if (!InputUsed(i)) return;
+      const uint64_t iRowBytes = vSize.x * m_vTypeSizes[i];
+      std::vector<uint8_t>& data = m_vInputData[i];
+      data.resize(size_t(vSize.volume() * m_vTypeSizes[i]));
+      for (uint64_t z = 0;z<vSize.z;z++) {
+        for (uint64_t y = 0;y<vSize.y;y++) {
+          m_vInputs[i]->SeekPos((((vOrigin.z + z) * m_vSize.y +
+                                  vOrigin.y + y) * m_vSize.x + vOrigin.x) *
+                                m_vTypeSizes[i]);
+          m_vInputs[i]->ReadRAW(&data[size_t((z * vSize.y + y) *
+                                             iRowBytes)], iRowBytes);
+        }
+      }
+    });
+
+    T* pTarget = reinterpret_cast<T*>(pData);
+    ParallelFor(size_t(vSize.z), WorkerCount(), [&](size_t z) {
+      std::vector<double> vResult(iSliceVoxels);
+      CombineSlice(z, iSliceVoxels, vResult.data());
+      StoreResults(vResult.data(), iSliceVoxels,
+                   pTarget + z * iSliceVoxels);
+    });
+  }
+
+private:
+  std::vector<std::shared_ptr<TOCSourceFile>>  m_vInputs;
+  std::vector<uint64_t>                        m_vTypeSizes;
+  std::vector<std::vector<uint8_t>>            m_vInputData;
+
+  // Integer results are clamped to the range of T, which saturates the
+  // infinities. NaN becomes 0; the clamp alone would turn it into the
+  // maximum of T. Float results keep NaN and infinity as they are.
+  static void StoreResults(const double* pResult, size_t iCount, T* pTarget) {
+    if (std::numeric_limits<T>::is_integer) {
+      const double fMin = double(std::numeric_limits<T>::lowest());
+      const double fMax = double(std::numeric_limits<T>::max());
+      for (size_t v = 0;v<iCount;v++) {
+        const double f = pResult[v];
+        pTarget[v] = (f != f) ? T(0) : T(std::max(fMin, std::min(fMax, f)));
+      }
+    } else {
+      for (size_t v = 0;v<iCount;v++) pTarget[v] = T(pResult[v]);
+    }
+  }
+};
+
+struct MergeParameters {
+  std::vector<double> vScales;
+  std::vector<double> vBiases;
+};
+
+// Type of a merged volume, from the range the sum can take: every input
+// contributes the image of its type range under scale and bias. Two
+// uint8 inputs with scale 1 thus give uint16, uint16 plus int8 gives
+// int32, while a sum that is scaled down keeps the input type.
+static ExtendedOctree::COMPONENT_TYPE
+ResultComponentType(const MergeParameters& parameters,
+                    const std::vector<const TOCBlock*>& vInputs) {
+  double fMin = 0.0, fMax = 0.0;
+  bool bFloat = false;
+  bool bWide = false;
+  for (size_t i = 0;i<vInputs.size();i++) {
+    const ExtendedOctree::COMPONENT_TYPE eType = vInputs[i]->GetComponentType();
+    double fTypeMin, fTypeMax;
+    ComponentTypeRange(eType, fTypeMin, fTypeMax);
+    const double fScale = parameters.vScales[i];
+    const double fBias = parameters.vBiases[i];
+    fMin += std::min(fScale * fTypeMin, fScale * fTypeMax) + fBias;
+    fMax += std::max(fScale * fTypeMin, fScale * fTypeMax) + fBias;
+    bFloat |= IsFloatType(eType);
+    bWide |= vInputs[i]->GetComponentTypeSize() == 8;
+  }
+  return ComponentTypeForRange(fMin, fMax, bFloat, bWide);
+}
+
+// The sum of scale * value + bias over all inputs.
+template<typename T>
+class MergedSourceFile : public CombinedSourceFile<T> {
+public:
+  MergedSourceFile(const std::string& strName,
+                   const std::vector<const TOCBlock*>& vInputs,
+                   const MergeParameters& parameters,
+                   uint64_t iInputCacheBytes, uint64_t iCacheBytes) :
+    CombinedSourceFile<T>(strName, vInputs, iInputCacheBytes, iCacheBytes),
+    m_Parameters(parameters)
+  {}
+
+protected:
+  virtual void CombineSlice(size_t z, size_t iVoxels,
+                            double* pResult) const {
+    std::fill(pResult, pResult + iVoxels, 0.0);
+    for (size_t i = 0;i<this->m_vTypes.size();i++)
+      AddScaledValues(this->m_vTypes[i], this->InputSlice(i, z, iVoxels),
+                      iVoxels, m_Parameters.vScales[i],
+                      m_Parameters.vBiases[i], pResult);
+  }
+
+private:
+  MergeParameters m_Parameters;
+};
+
+template<template<typename> class Source, typename Parameters>
+static LargeRAWFile_ptr
+CreateCombinedSource(ExtendedOctree::COMPONENT_TYPE eType,
+                     const std::string& strName,
+                     const std::vector<const TOCBlock*>& vInputs,
+                     const Parameters& parameters,
+                     uint64_t iInputCacheBytes, uint64_t iCacheBytes) {
+  switch (eType) {
+#define COMBINED_SOURCE(CT, T)                                              \
+    case ExtendedOctree::CT :                                               \
+      return LargeRAWFile_ptr(new Source<T>(strName, vInputs, parameters,   \
+                                            iInputCacheBytes, iCacheBytes));
+    COMBINED_SOURCE(CT_UINT8,   uint8_t)
+    COMBINED_SOURCE(CT_INT8,    int8_t)
+    COMBINED_SOURCE(CT_UINT16,  uint16_t)
+    COMBINED_SOURCE(CT_INT16,   int16_t)
+    COMBINED_SOURCE(CT_UINT32,  uint32_t)
+    COMBINED_SOURCE(CT_INT32,   int32_t)
+    COMBINED_SOURCE(CT_FLOAT32, float)
+    default :
+    COMBINED_SOURCE(CT_FLOAT64, double)
+#undef COMBINED_SOURCE
+  }
+}
+
+// Writes the single component TOC volumes of all files in vSources,
+// combined voxel by voxel by Source<T>, as a new UVF file strTarget. The
+// combined volume is computed block by block while the bricker consumes
+// it, neither the inputs nor the combined volume are written out in
+// between. bNoTOCVolume is set if one of the sources does not have
+// exactly one TOC volume, strTarget is not touched then.
+template<template<typename> class Source, typename Parameters>
+static bool CombineUVFs(const std::vector<std::string>& vSources,
+                        const Parameters& parameters,
+                        const std::string& strBlockID,
+                        std::shared_ptr<KeyValuePairDataBlock> metaPairs,
+                        const std::string& strTarget,
+                        uint32_t iBrickSize, uint32_t iOverlap,
+                        uint32_t iCompression, uint32_t iCompressionLevel,
+                        uint32_t iLayout, uint64_t iMemory,
+                        bool& bNoTOCVolume) {
+  bNoTOCVolume = false;
+  if (vSources.empty()) {
+    T_ERROR("No input volumes");
+    return false;
+  }
+  std::vector<std::shared_ptr<UVF>> vFiles;
+  std::vector<const TOCBlock*> vInputs;
+  for (size_t i = 0;i<vSources.size();i++) {
+    vFiles.push_back(std::shared_ptr<UVF>(
+      new UVF(std::wstring(vSources[i].begin(), vSources[i].end()))));
+    std::string strProblem;
+    if (!vFiles[i]->Open(false, false, false, &strProblem)) {
+      T_ERROR("Could not open %s: %s", vSources[i].c_str(),
+              strProblem.c_str());
+      return false;
+    }
+    const TOCBlock* toc = FindTOCVolume(*vFiles[i], strProblem);
+    if (!toc) {
+      bNoTOCVolume = true;
+      MESSAGE("%s %s, it cannot be read brick by brick",
+              vSources[i].c_str(), strProblem.c_str());
+      return false;
+    }
+    if (toc->GetComponentCount() != 1) {
+      T_ERROR("%s is not a scalar volume", vSources[i].c_str());
+      return false;
+    }
+    if (!vInputs.empty() &&
+        toc->GetLODDomainSize(0) != vInputs.front()->GetLODDomainSize(0)) {
+      T_ERROR("%s differs in size from %s", vSources[i].c_str(),
+              vSources[0].c_str());
+      return false;
+    }
+    vInputs.push_back(toc);
+  }
+
+  // the bricker gets half of the memory, the caches of the combined blocks
+  // and of the input bricks share the other half
+  const uint64_t iMinCache = 64*1024*1024;
+  const uint64_t iCombinedCache = std::max(iMemory / 4, iMinCache);
+  const uint64_t iInputCache = std::max(iMemory / 4 / vInputs.size(),
+                                        iMinCache);
+  const uint64_t iBrickerCache = std::max(iMemory / 2, iMinCache);
+
+  const ExtendedOctree::COMPONENT_TYPE eType =
+    ResultComponentType(parameters, vInputs);
+  LargeRAWFile_ptr combined = CreateCombinedSource<Source>(
+    eType, strTarget, vInputs, parameters, iInputCache, iCombinedCache
+  );
+  combined->Open(false);
+
+  std::shared_ptr<MaxMinDataBlock> maxMin(new MaxMinDataBlock(1));
+  std::shared_ptr<TOCBlock> volume(new TOCBlock(UVF::ms_ulReaderVersion));
+  volume->strBlockID = strBlockID;
+  volume->ulCompressionScheme = UVFTables::COS_NONE;
+
+  // the bricker builds the hierarchy next to the target
+  const std::string strTempFile = strTarget + ".tmp";
+  const bool bBricked = volume->FlatDataToBrickedLOD(
+    combined, strTempFile, eType, 1, vInputs[0]->GetLODDomainSize(0),
+    vInputs[0]->GetScale(),
+    UINT64VECTOR3(iBrickSize, iBrickSize, iBrickSize), iOverlap,
+    false, false, size_t(iBrickerCache), maxMin, &Controller::Debug::Out(),
+    static_cast<COMPRESSION_TYPE>(iCompression), iCompressionLevel,
+    static_cast<LAYOUT_TYPE>(iLayout)
+  );
+  combined->Close();
+  for (size_t i = 0;i<vFiles.size();i++) vFiles[i]->Close();
+  if (!bBricked) {
+    T_ERROR("Failed to brick the %s", strBlockID.c_str());
+    return false;
+  }
+
+  // as in the converter, histograms only for 8 and 16 bit unsigned data
+  std::shared_ptr<Histogram1DDataBlock> histogram1D(
+    new Histogram1DDataBlock()
+  );
+  std::shared_ptr<Histogram2DDataBlock> histogram2D(
+    new Histogram2DDataBlock()
+  );
+  const bool bHistograms = eType == ExtendedOctree::CT_UINT8 ||
+                           eType == ExtendedOctree::CT_UINT16;
+  if (bHistograms) {
+    MESSAGE("Computing 1D and 2D Histogram...");
+    const uint64_t iMaxValue =
+      uint64_t(std::max(0.0, maxMin->GetGlobalValue().maxScalar));
+    std::string strProblem;
+    const bool bComputed = (eType == ExtendedOctree::CT_UINT8)
+      ? ComputeHistograms<uint8_t>(volume.get(), strTempFile, iMaxValue,
+                                   4096, WorkerCount(), *histogram1D,
+                                   *histogram2D, strProblem)
+      : ComputeHistograms<uint16_t>(volume.get(), strTempFile, iMaxValue,
+                                    4096, WorkerCount(), *histogram1D,
+                                    *histogram2D, strProblem);
+    if (!bComputed) {
+      T_ERROR("Computation of the histograms failed: %s",
+              strProblem.c_str());
+      return false;
+    }
+    histogram1D->Compress(4096);
+  }
+
+  UVF target(std::wstring(strTarget.begin(), strTarget.end()));
+  GlobalHeader header;
+  header.ulChecksumSemanticsEntry = UVFTables::CS_MD5;
+  target.SetGlobalHeader(header);
+  target.AddDataBlock(volume);
+  if (bHistograms) {
+    target.AddDataBlock(histogram1D);
+    target.AddDataBlock(histogram2D);
+  }
+  target.AddDataBlock(maxMin);
+  target.AddDataBlock(metaPairs);
+
+  MESSAGE("Writing %s ...", strTarget.c_str());
+  const bool bCreated = target.Create();
+  target.Close();
+  if (!bCreated) {
+    T_ERROR("Failed to create %s", strTarget.c_str());
+    return false;
+  }
+  return true;
+}
+
+// Merges the single component TOC volumes of all files in vSources into
+// strTarget, every voxel becomes sum_i (vScales[i] * v_i + vBiases[i]).
+// bNoTOCVolume is set if one of the sources does not have exactly one TOC
+// volume, strTarget is not touched then.
+static bool MergeUVFs(const std::vector<std::string>& vSources,
+                      const std::vector<double>& vScales,
+                      const std::vector<double>& vBiases,
+                      const std::string& strTarget,
+                      uint32_t iBrickSize, uint32_t iOverlap,
+                      uint32_t iCompression, uint32_t iCompressionLevel,
+                      uint32_t iLayout, uint64_t iMemory,
+                      bool& bNoTOCVolume) {
+  MergeParameters parameters;
+  parameters.vScales = vScales;
+  parameters.vBiases = vBiases;
+
+  std::shared_ptr<KeyValuePairDataBlock> metaPairs(
+    new KeyValuePairDataBlock()
+  );
+  metaPairs->AddPair("Data Source", "Merged by the UVF converter");
+  for (size_t i = 0;i<vSources.size();i++)
+    metaPairs->AddPair("Merge Input " + SysTools::ToString(i),
+                       vSources[i] + " (scale " +
+                       SysTools::ToString(vScales[i]) + ", bias " +
+                       SysTools::ToString(vBiases[i]) + ")");
+
+  MESSAGE("Merging %u volumes ...", unsigned(vSources.size()));
+  return CombineUVFs<MergedSourceFile>(vSources, parameters, "Merged Volume",
+                                       metaPairs, strTarget, iBrickSize,
+                                       iOverlap, iCompression,
+                                       iCompressionLevel, iLayout, iMemory,
+                                       bNoTOCVolume);
+}
+
+#endif // UVFMERGE_H
@@ -0,0 +1,350 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2013 Interactive Visualization and Data Analysis Group
+
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+  \file    UVFRebrick.h
+  \brief   Rebricks and recompresses the TOC volume of a UVF file into a new
+           UVF file without an intermediate flat copy of the volume.
+*/
+
+#pragma once
+
+#ifndef UVFREBRICK_H
+#define UVFREBRICK_H
+
+#include <algorithm>
+#include <cstring>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../Tuvok/StdTuvokDefines.h"
+#include "../Tuvok/Controller/Controller.h"
+#include "../Tuvok/Basics/LargeRAWFile.h"
+#include "../Tuvok/Basics/SysTools.h"
+#include "../Tuvok/Basics/Vectors.h"
+#include "../Tuvok/IO/UVF/UVF.h"
+#include "../Tuvok/IO/UVF/TOCBlock.h"
+#include "../Tuvok/IO/UVF/MaxMinDataBlock.h"
+
+// A read-only stand-in for the flat volume that the bricker expects as its
+// input. The volume is split into a grid of blocks, each block may carry
+// iOverlap extra voxels on every side (as the bricks of a TOC block do).
+// Derived classes fill the blocks; filled blocks are kept in an LRU cache of
+// bounded size, so neighbouring reads do not fill the same block again as
+// long as it fits.
+class BlockCacheFile : public LargeRAWFile {
+public:
+  BlockCacheFile(const std::string& strName, const UINT64VECTOR3& vSize,
+                 uint64_t iVoxelSize, const UINT64VECTOR3& vInner,
+                 uint64_t iOverlap, uint64_t iCacheBytes) :
+    LargeRAWFile(strName),
+    m_vSize(vSize),
+    m_vInner(vInner),
+    m_vBlockCount((vSize.x + vInner.x - 1) / vInner.x,
+                  (vSize.y + vInner.y - 1) / vInner.y,
+                  (vSize.z + vInner.z - 1) / vInner.z),
+    m_iOverlap(iOverlap),
+    m_iVoxelSize(iVoxelSize),
+    m_iCacheBytes(iCacheBytes),
+    m_iCachedBytes(0),
+    m_iPos(0)
+  {}
+
+  virtual bool Open(bool bReadWrite=false) {
+    m_iPos = 0;
+    return !bReadWrite;
+  }
+  virtual bool IsOpen() const { return true; }
+  virtual bool IsWritable() const { return false; }
+  virtual void Close() {
+    m_Cache.clear();
+    m_LRU.clear();
+    m_iCachedBytes = 0;
+  }
+  virtual bool Delete() { Close(); return true; }
+  virtual uint64_t GetCurrentSize() { return m_vSize.volume()*m_iVoxelSize; }
+
+  virtual void SeekStart() { m_iPos = 0; }
+  virtual uint64_t SeekEnd() { return m_iPos = GetCurrentSize(); }
+  virtual uint64_t GetPos() { return m_iPos; }
+  virtual void SeekPos(uint64_t iPos) { m_iPos = iPos; }
+
+  virtual size_t ReadRAW(unsigned char* pData, uint64_t iCount) {
+    const uint64_t iSize = GetCurrentSize();
+    if (m_iPos >= iSize) return 0;
+    iCount = std::min(iCount, iSize-m_iPos);
+
+    // reads need not start or end on a voxel boundary, the bytes of one
+    // row inside one block are contiguous in both layouts
+    const uint64_t iRowBytes = m_vSize.x * m_iVoxelSize;
+    uint64_t iDone = 0;
+    while (iDone < iCount) {
+      const uint64_t iPos = m_iPos + iDone;
+      const uint64_t iRow = iPos / iRowBytes;
+      const uint64_t iRowByte = iPos % iRowBytes;
+      const uint64_t y = iRow % m_vSize.y;
+      const uint64_t z = iRow / m_vSize.y;
+      const uint64_t x = iRowByte / m_iVoxelSize;
+      const UINT64VECTOR4 key(x / m_vInner.x, y / m_vInner.y,
+                              z / m_vInner.z, 0);
+      const UINT64VECTOR3 vOrigin(key.x * m_vInner.x, key.y * m_vInner.y,
+                                  key.z * m_vInner.z);
+      const uint64_t iSegmentEnd = std::min(iRowBytes,
+                                            (vOrigin.x + m_vInner.x) *
+                                            m_iVoxelSize);
+      const uint64_t iBytes = std::min(iCount - iDone,
+                                       iSegmentEnd - iRowByte);
+
+      const UINT64VECTOR3 vBlockSize = BlockSize(key);
+      const uint64_t iSource =
+        ((z - vOrigin.z + m_iOverlap) * vBlockSize.y +
+         (y - vOrigin.y + m_iOverlap)) * vBlockSize.x * m_iVoxelSize +
+        (m_iOverlap * m_iVoxelSize + iRowByte - vOrigin.x * m_iVoxelSize);
+      const std::vector<uint8_t>& block = GetBlock(key);
+      std::memcpy(pData + iDone, block.data() + iSource, size_t(iBytes));
+      iDone += iBytes;
+    }
+    m_iPos += iCount;
+    return size_t(iCount);
+  }
+
+  virtual size_t WriteRAW(const unsigned char*, uint64_t) { return 0; }
+
+protected:
+  UINT64VECTOR3 m_vSize;
+  UINT64VECTOR3 m_vInner;
+  UINT64VECTOR3 m_vBlockCount;
+  uint64_t      m_iOverlap;
+  uint64_t      m_iVoxelSize;
+
+  // size of a block including its overlap
+  virtual UINT64VECTOR3 BlockSize(const UINT64VECTOR4& key) const {
+    return UINT64VECTOR3(
+      std::min(m_vInner.x, m_vSize.x - key.x * m_vInner.x) + 2 * m_iOverlap,
+      std::min(m_vInner.y, m_vSize.y - key.y * m_vInner.y) + 2 * m_iOverlap,
+      std::min(m_vInner.z, m_vSize.z - key.z * m_vInner.z) + 2 * m_iOverlap);
+  }
+  virtual void FillBlock(const UINT64VECTOR4& key, uint8_t* pData) = 0;
+
+private:
+  struct CachedBlock {
+    std::vector<uint8_t>           data;
+    std::list<uint64_t>::iterator  lru;
+  };
+
+  uint64_t                        m_iCacheBytes;
+  uint64_t                        m_iCachedBytes;
+  uint64_t                        m_iPos;
+  std::map<uint64_t, CachedBlock> m_Cache;
+  std::list<uint64_t>             m_LRU;   // most recently used first
+
+  const std::vector<uint8_t>& GetBlock(const UINT64VECTOR4& key) {
+    const uint64_t iIndex = (key.z * m_vBlockCount.y + key.y) *
+                            m_vBlockCount.x + key.x;
+    std::map<uint64_t, CachedBlock>::iterator i = m_Cache.find(iIndex);
+    if (i != m_Cache.end()) {
+      m_LRU.splice(m_LRU.begin(), m_LRU, i->second.lru);
+      return i->second.data;
+    }
+
+    const uint64_t iBytes = BlockSize(key).volume() * m_iVoxelSize;
+    // the block that is about to be filled always stays in the cache
+    while (!m_LRU.empty() && m_iCachedBytes + iBytes > m_iCacheBytes) {
+      std::map<uint64_t, CachedBlock>::iterator victim =
+        m_Cache.find(m_LRU.back());
+      m_iCachedBytes -= victim->second.data.size();
+      m_Cache.erase(victim);
+      m_LRU.pop_back();
+    }
+
+    m_LRU.push_front(iIndex);
+    CachedBlock& b = m_Cache[iIndex];
+    b.lru = m_LRU.begin();
+    b.data.resize(size_t(iBytes));
+    FillBlock(key, b.data.data());
+    m_iCachedBytes += iBytes;
+    return b.data;
+  }
+};
+
+// Serves the finest LoD of an open TOC block, the blocks are its bricks.
+class TOCSourceFile : public BlockCacheFile {
+public:
+  TOCSourceFile(const std::string& strName, const TOCBlock* toc,
+                uint64_t iCacheBytes) :
+    BlockCacheFile(strName, toc->GetLODDomainSize(0),
+                   toc->GetComponentTypeSize() * toc->GetComponentCount(),
+                   UINT64VECTOR3(toc->GetMaxBrickSize().x -
+                                 2 * toc->GetOverlap(),
+                                 toc->GetMaxBrickSize().y -
+                                 2 * toc->GetOverlap(),
+                                 toc->GetMaxBrickSize().z -
+                                 2 * toc->GetOverlap()),
+                   toc->GetOverlap(), iCacheBytes),
+    m_toc(toc)
+  {}
+
+protected:
+  virtual UINT64VECTOR3 BlockSize(const UINT64VECTOR4& key) const {
+    return m_toc->GetBrickSize(key);
+  }
+  virtual void FillBlock(const UINT64VECTOR4& key, uint8_t* pData) {
+    m_toc->GetData(pData, key);
+  }
+
+private:
+  const TOCBlock* m_toc;
+};
+
+// The TOC volume of a file. NULL if it has none, or if it has several,
+// one per timestep: the direct paths handle a single volume only and must
+// not silently drop the other timesteps. strProblem tells which case.
+static const TOCBlock* FindTOCVolume(const UVF& uvfFile,
+                                     std::string& strProblem) {
+  const TOCBlock* toc = NULL;
+  uint64_t iCount = 0;
+  for (uint64_t i = 0;i<uvfFile.GetDataBlockCount();i++) {
+    const DataBlock* b = uvfFile.GetDataBlock(i).get();
+    if (b->GetBlockSemantic() == UVFTables::BS_TOC_BLOCK) {
+      if (iCount++ == 0) toc = dynamic_cast<const TOCBlock*>(b);
+    }
+  }
+  if (iCount == 0) {
+    strProblem = "has no TOC volume";
+    return NULL;
+  }
+  if (iCount > 1) {
+    strProblem = "has " + SysTools::ToString(iCount) + " TOC volumes";
+    return NULL;
+  }
+  return toc;
+}
+
+// Writes the TOC volume of strSource with new brick size, overlap,
+// compression and layout to strTarget. The finest LoD is streamed from the
+// source bricks straight into the bricker, the coarser LoDs and the min/max
+// acceleration data are rebuilt. Histograms, meta data and geometry do not
+// depend on the bricking and are copied. bNoTOCVolume is set if the
+// source does not have exactly one TOC volume, strTarget is not touched
+// then.
+static bool RebrickUVF(const std::string& strSource,
+                       const std::string& strTarget,
+                       uint32_t iBrickSize, uint32_t iOverlap,
+                       uint32_t iCompression, uint32_t iCompressionLevel,
+                       uint32_t iLayout, uint64_t iMemory,
+                       bool& bNoTOCVolume) {
+  bNoTOCVolume = false;
+  UVF source(std::wstring(strSource.begin(), strSource.end()));
+  std::string strProblem;
+  if (!source.Open(false, false, false, &strProblem)) {
+    T_ERROR("Could not open %s: %s", strSource.c_str(), strProblem.c_str());
+    return false;
+  }
+  const TOCBlock* sourceVolume = FindTOCVolume(source, strProblem);
+  if (!sourceVolume) {
+    bNoTOCVolume = true;
+    MESSAGE("%s %s, it cannot be rebricked directly", strSource.c_str(),
+            strProblem.c_str());
+    source.Close();
+    return false;
+  }
+
+  UVF target(std::wstring(strTarget.begin(), strTarget.end()));
+  GlobalHeader header;
+  header.ulChecksumSemanticsEntry = UVFTables::CS_MD5;
+  target.SetGlobalHeader(header);
+
+  // the bricker and the cache of source bricks share the memory budget
+  const uint64_t iSourceCache = std::max<uint64_t>(iMemory / 4,
+                                                   64*1024*1024);
+  const uint64_t iBrickerCache = iMemory - std::min(iMemory, iSourceCache);
+  LargeRAWFile_ptr flat(new TOCSourceFile(strSource, sourceVolume,
+                                          iSourceCache));
+  flat->Open(false);
+
+  std::shared_ptr<MaxMinDataBlock> maxMin(
+    new MaxMinDataBlock(size_t(sourceVolume->GetComponentCount()))
+  );
+  std::shared_ptr<TOCBlock> volume(new TOCBlock(UVF::ms_ulReaderVersion));
+  volume->strBlockID = sourceVolume->strBlockID;
+  volume->ulCompressionScheme = UVFTables::COS_NONE;
+
+  MESSAGE("Rebricking %s ...", strSource.c_str());
+  // the bricker builds the hierarchy next to the target
+  const std::string strTempFile = strTarget + ".tmp";
+  const bool bBricked = volume->FlatDataToBrickedLOD(
+    flat, strTempFile, sourceVolume->GetComponentType(),
+    sourceVolume->GetComponentCount(), sourceVolume->GetLODDomainSize(0),
+    sourceVolume->GetScale(),
+    UINT64VECTOR3(iBrickSize, iBrickSize, iBrickSize), iOverlap,
+    false, false, size_t(std::max<uint64_t>(iBrickerCache, 64*1024*1024)),
+    maxMin, &Controller::Debug::Out(),
+    static_cast<COMPRESSION_TYPE>(iCompression), iCompressionLevel,
+    static_cast<LAYOUT_TYPE>(iLayout)
+  );
+  flat->Close();
+  if (!bBricked) {
+    T_ERROR("Failed to rebrick the volume of %s", strSource.c_str());
+    source.Close();
+    return false;
+  }
+
+  target.AddDataBlock(volume);
+  target.AddDataBlock(maxMin);
+  for (uint64_t i = 0;i<source.GetDataBlockCount();i++) {
+    const std::shared_ptr<DataBlock> b = source.GetDataBlock(i);
+    switch (b->GetBlockSemantic()) {
+      case UVFTables::BS_1D_HISTOGRAM :
+      case UVFTables::BS_2D_HISTOGRAM :
+      case UVFTables::BS_GEOMETRY :
+        target.AddDataBlock(std::shared_ptr<DataBlock>(b->Clone()));
+        break;
+      case UVFTables::BS_KEY_VALUE_PAIRS :
+        // the per brick checksums of the UVFReader describe the old bricks
+        if (b->strBlockID != "Brick Checksums")
+          target.AddDataBlock(std::shared_ptr<DataBlock>(b->Clone()));
+        break;
+      default :
+        break;
+    }
+  }
+
+  MESSAGE("Writing %s ...", strTarget.c_str());
+  const bool bCreated = target.Create();
+  target.Close();
+  source.Close();
+  if (!bCreated) {
+    T_ERROR("Failed to create %s", strTarget.c_str());
+    return false;
+  }
+  return true;
+}
+
+#endif // UVFREBRICK_H
@@ -36,10 +36,14 @@
 //!    Copyright (C) 2008 SCI Institute
 
 #include "../Tuvok/StdTuvokDefines.h"
+#include <algorithm>
+#include <atomic>
 #include <cstdlib>
 #include <iostream>
+#include <mutex>
 #include <string>
 #include <sstream>
+#include <thread>
 #include <vector>
 #include <tclap/CmdLine.h>
 
@@ -54,6 +58,10 @@
 #include "../Tuvok/IO/TuvokIOError.h"
 #include "../Tuvok/IO/uvfDataset.h"
 
+#include "UVFExpression.h"
+#include "UVFMerge.h"
+#include "UVFRebrick.h"
+
 using namespace std;
 using namespace tuvok;
 
@@ -92,6 +100,30 @@ enum {
 
 static int export_data(const IOManager&, const std::string in,
                        const std::string out);
+static int rebrick_data(const IOManager&, const std::string& in,
+                        const std::string& out, uint32_t bricksize,
+                        uint32_t brickoverlap, uint32_t compression,
+                        uint32_t level, uint32_t layout, uint64_t memory);
+static int merge_data(const IOManager&, const std::vector<std::string>& in,
+                      const std::vector<double>& scales,
+                      const std::vector<double>& biases,
+                      const std::string& out, uint32_t bricksize,
+                      uint32_t brickoverlap, uint32_t compression,
+                      uint32_t level, uint32_t layout, uint64_t memory);
+
+// -s and -b are given once per merged volume, or once per volume after the
+// first one, which is then taken as is; without them every volume is taken
+// as is.
+static bool merge_parameters(std::vector<double>& values, size_t count,
+                             double identity)
+{
+  if(values.empty()) {
+    values.assign(count, identity);
+  } else if(values.size() + 1 == count) {
+    values.insert(values.begin(), identity);
+  }
+  return values.size() == count;
+}
 
 // reads an entire file into a string.
 static std::string readfile(const std::string& filename)
@@ -137,14 +169,15 @@ int main(int argc, const char* argv[])
   string strInFile2;
   string strInDir;
   string strOutFile;
-  double fScale = 0.0;
-  double fBias = 0.0;
+  std::vector<double> vScales;
+  std::vector<double> vBiases;
   bool debug;
   uint32_t bricksize = 64;
   uint32_t bricklayout = 0; // 0 is default scanline layout
   const uint32_t brickoverlap = 2;
   uint32_t compression = 1; // 1 is default zlib compression
   uint32_t level = 1; // generic compression level 1 is best speed
+  uint32_t jobs = 1; // stacks converted at the same time in directory mode
   float fMem = 0.8f;
 
   try {
@@ -159,12 +192,14 @@ int main(int argc, const char* argv[])
                                       "merge expression", false, "", "string");
     TCLAP::ValueArg<std::string> output("o", "output", "output file (uvf)",
                                         true, "", "filename");
-    TCLAP::ValueArg<double> bias("b", "bias",
-                                 "(merging) bias value for second file",
-                                 false, 0.0, "floating point number");
-    TCLAP::ValueArg<double> scale("s", "scale",
-                                  "(merging) scaling value for second file",
-                                  false, 0.0, "floating point number");
+    TCLAP::MultiArg<double> bias("b", "bias",
+                                 "(merging) bias value, repeat once per "
+                                 "input file or once per input file after "
+                                 "the first", false, "floating point number");
+    TCLAP::MultiArg<double> scale("s", "scale",
+                                  "(merging) scaling value, repeat once per "
+                                  "input file or once per input file after "
+                                  "the first", false, "floating point number");
     TCLAP::ValueArg<float> opt_mem("m", "memory",
                                    "max allowed fraction of installed RAM to use"
                                    " (0.05..0.95)",
@@ -183,6 +218,10 @@ int main(int argc, const char* argv[])
     TCLAP::ValueArg<uint32_t> opt_level("v", "level", "UVF compression level "
                                         "between (1..10)",
                                         false, 1, "positive integer");
+    TCLAP::ValueArg<uint32_t> opt_jobs("j", "jobs", "number of stacks to "
+                                       "convert at the same time in "
+                                       "directory mode, 0 is one per core "
+                                       "(1)", false, 1, "positive integer");
     TCLAP::SwitchArg dbg("g", "debug", "Enable debugging mode", false);
     TCLAP::SwitchArg experim("", "experimental",
                              "Enable experimental features", false);
@@ -196,6 +235,7 @@ int main(int argc, const char* argv[])
     cmd.add(opt_bricklayout);
     cmd.add(opt_compression);
     cmd.add(opt_level);
+    cmd.add(opt_jobs);
     cmd.add(expr);
     cmd.add(dbg);
     cmd.add(experim);
@@ -213,13 +253,24 @@ int main(int argc, const char* argv[])
       strInDir = directory.getValue();
     }
     strOutFile = output.getValue();
-    fBias = bias.getValue();
-    fScale = scale.getValue();
+    vBiases = bias.getValue();
+    vScales = scale.getValue();
+    if(input.size() > 1 &&
+       (!merge_parameters(vScales, input.size(), 1.0) ||
+        !merge_parameters(vBiases, input.size(), 0.0))) {
+      std::cerr << "error: give -s and -b once per input file or once per "
+                << "input file after the first\n";
+      return EXIT_FAILURE_ARG;
+    }
     fMem = opt_mem.getValue();
     bricksize = opt_bricksize.getValue();
     bricklayout = opt_bricklayout.getValue();
     compression = opt_compression.getValue();
     level = opt_level.getValue();
+    jobs = opt_jobs.getValue();
+    if(jobs == 0) {
+      jobs = std::max(1u, std::thread::hardware_concurrency());
+    }
 
     if(expr.isSet()) {
       expression = expr.getValue();
@@ -273,6 +324,16 @@ int main(int argc, const char* argv[])
         return EXIT_FAILURE_NEED_UVF;
       }
     }
+    // compiled and evaluated brick by brick if possible
+    bool bUnsupported;
+    if(EvaluateUVFs(expression, input, strOutFile, bricksize, brickoverlap,
+                    compression, level, bricklayout,
+                    uint64_t(mem)*1024*1024, bUnsupported)) {
+      return EXIT_SUCCESS;
+    }
+    if(!bUnsupported) {
+      return EXIT_FAILURE;
+    }
     try {
       ioMan.EvaluateExpression(expression.c_str(), input, strOutFile);
     } catch(const std::exception& e) {
@@ -308,7 +369,18 @@ int main(int argc, const char* argv[])
     bool bIsVolExt1 = ioMan.GetConverterForExt(sourceType, false, false) != NULL;
     bool bIsGeoExt1 = ioMan.GetGeoConverterForExt(sourceType, false, false) != NULL;
 
+    if (!strInFile2.empty()) {
+      return merge_data(ioMan, input, vScales, vBiases, strOutFile,
+                        bricksize, brickoverlap, compression, level,
+                        bricklayout, uint64_t(mem)*1024*1024);
+    }
+
     if(!ioMan.NeedsConversion(strInFile)) {
+      if(targetType == "uvf") {
+        return rebrick_data(ioMan, strInFile, strOutFile, bricksize,
+                            brickoverlap, compression, level, bricklayout,
+                            uint64_t(mem)*1024*1024);
+      }
       return export_data(ioMan, strInFile, strOutFile);
     }
 
@@ -357,124 +429,44 @@ int main(int argc, const char* argv[])
       }
     }
 
-    if (strInFile2.empty()) {
-      if (bIsVolExt1) {
-        if (targetType == "uvf" && sourceType == "uvf") {
-          cout << endl << "Running in UVF to UVF mode, "
-               << "perserving only the raw data from " << strInFile << " to "
-               << strOutFile << endl;
-
-          cout << "Step 1. Extracting raw data" << endl;
-          /// use some simple format as intermediate file
-          string tmpFile = SysTools::ChangeExt(strOutFile,"nrrd");
-
-          // HACK: use the output file's dir as temp dir
-          if (ioMan.ConvertDataset(strInFile, tmpFile,
-                                   SysTools::GetPath(tmpFile), true,
-                                   bricksize, brickoverlap)) {
-            cout << endl << "Success." << endl << endl;
-          } else {
-            cout << endl << "Extraction failed!" << endl << endl;
-            return EXIT_FAILURE_TO_RAW;
-          }
-
-          cout << "Step 2. Writing new UVF file" << endl;
-          // HACK: use the output file's dir as temp dir
-          if (ioMan.ConvertDataset(tmpFile, strOutFile,
-                                   SysTools::GetPath(strOutFile), true,
-                                   bricksize, brickoverlap)) {
-            if(std::remove(tmpFile.c_str()) == -1) {
-             cout << endl << "Conversion succeeded but "
-                  << " could not delete tmp file " << tmpFile << "\n\n";
-            } else {
-             cout << "\nSuccess.\n\n";
-            }
-            return EXIT_SUCCESS;
-          } else {
-            if(std::remove(tmpFile.c_str()) == -1) {
-             cout << "\nUVF write failed and could not delete tmp file "
-                  << tmpFile << "\n\n";
-            } else {
-             cout << "\nUVF write failed.\n\n";
-            }
-            return EXIT_FAILURE_TO_UVF;
-          }
+    if (bIsVolExt1) {
+      if (targetType == "uvf" && sourceType == "uvf") {
+        return rebrick_data(ioMan, strInFile, strOutFile, bricksize,
+                            brickoverlap, compression, level, bricklayout,
+                            uint64_t(mem)*1024*1024);
+      } else {
+        cout << endl << "Running in volume file mode.\nConverting "
+             << strInFile << " to " << strOutFile << "\n\n";
+        // HACK: use the output file's dir as temp dir
+        if (ioMan.ConvertDataset(strInFile, strOutFile,
+                                 SysTools::GetPath(strOutFile), true,
+                                 bricksize, brickoverlap)) {
+          cout << "\nSuccess.\n\n";
+          return EXIT_SUCCESS;
         } else {
-          cout << endl << "Running in volume file mode.\nConverting "
-               << strInFile << " to " << strOutFile << "\n\n";
-          // HACK: use the output file's dir as temp dir
-          if (ioMan.ConvertDataset(strInFile, strOutFile,
-                                   SysTools::GetPath(strOutFile), true,
-                                   bricksize, brickoverlap)) {
-            cout << "\nSuccess.\n\n";
-            return EXIT_SUCCESS;
-          } else {
-            cout << "\nConversion failed!\n\n";
-            return EXIT_FAILURE_GENERAL;
-          }
+          cout << "\nConversion failed!\n\n";
+          return EXIT_FAILURE_GENERAL;
         }
-      } else {
-          AbstrGeoConverter* sourceConv = ioMan.GetGeoConverterForExt(sourceType, false, true);
-          AbstrGeoConverter* targetConv = ioMan.GetGeoConverterForExt(targetType, true, false);
-
-          cout << "\nRunning in geometry file mode.\n"
-               << "Converting " << strInFile
-               << " (" << sourceConv->GetDesc() << ") to "
-               << strOutFile << " (" << targetConv->GetDesc() << ")\n";
-          std::shared_ptr<Mesh> m;
-          try {
-            m = sourceConv->ConvertToMesh(strInFile);
-          } catch (const tuvok::io::DSOpenFailed& err) {
-            cerr << "Error trying to open the input mesh "
-                 << "(" << err.what() << ")\n";
-            return EXIT_FAILURE_IN_MESH_LOAD;
-          }
-          if (!targetConv->ConvertToNative(*m,strOutFile)) {
-            cerr << "Error writing target mesh\n";
-            return EXIT_FAILURE_OUT_MESH_WRITE;
-          }
       }
     } else {
-
-      string sourceType2 = SysTools::ToLowerCase(SysTools::GetExt(strInFile2));
-
-      bool bIsVolExt2 = ioMan.GetConverterForExt(sourceType2, false, true) != NULL;
-      bool bIsGeoExt2 = ioMan.GetGeoConverterForExt(sourceType2, false, true) != NULL;
-
-      if (!bIsVolExt2 && !bIsGeoExt2)  {
-        std::cerr << "error: Unknown file type for '" << strInFile2 << "'\n";
-        return EXIT_FAILURE_UNKNOWN_2;
+      AbstrGeoConverter* sourceConv = ioMan.GetGeoConverterForExt(sourceType, false, true);
+      AbstrGeoConverter* targetConv = ioMan.GetGeoConverterForExt(targetType, true, false);
+
+      cout << "\nRunning in geometry file mode.\n"
+           << "Converting " << strInFile
+           << " (" << sourceConv->GetDesc() << ") to "
+           << strOutFile << " (" << targetConv->GetDesc() << ")\n";
+      std::shared_ptr<Mesh> m;
+      try {
+        m = sourceConv->ConvertToMesh(strInFile);
+      } catch (const tuvok::io::DSOpenFailed& err) {
+        cerr << "Error trying to open the input mesh "
+             << "(" << err.what() << ")\n";
+        return EXIT_FAILURE_IN_MESH_LOAD;
       }
-
-      if (bIsGeoExt2)   {
-        std::cerr << "error: Mesh merge not supported at the moment\n";
-        return EXIT_FAILURE_MESH_MERGE;
-      }
-
-      vector<string> vDataSets;
-      vector<double> vScales;
-      vector<double> vBiases;
-      vDataSets.push_back(strInFile);
-      vScales.push_back(1.0);
-      vBiases.push_back(0.0);
-      vDataSets.push_back(strInFile2);
-      vScales.push_back(fScale);
-      vBiases.push_back(fBias);
-
-      cout << endl << "Running in merge mode.\nConverting";
-      for (size_t i = 0;i<<vDataSets.size();i++) {
-        cout << " " << vDataSets[i];
-      }
-      cout << " to " << strOutFile << "\n\n";
-
-      // HACK: use the output file's dir as temp dir
-      if (ioMan.MergeDatasets(vDataSets, vScales, vBiases, strOutFile,
-                              SysTools::GetPath(strOutFile))) {
-        cout << "\nSuccess.\n\n";
-        return EXIT_SUCCESS;
-      } else {
-        cout << "\nMerging datasets failed!\n\n";
-        return EXIT_FAILURE_MERGE;
+      if (!targetConv->ConvertToNative(*m,strOutFile)) {
+        cerr << "Error writing target mesh\n";
+        return EXIT_FAILURE_OUT_MESH_WRITE;
       }
     }
   } else {
@@ -510,25 +502,199 @@ int main(int argc, const char* argv[])
       }
     }
 
-    int iFailCount = 0;
+    // the stacks are independent, every job gets its own IOManager and an
+    // equal share of the memory budget so the jobs together stay within it
+    const uint32_t iJobs = std::max(1u, std::min(jobs,
+                                                 uint32_t(dirinfo.size())));
+    if (iJobs > 1) {
+      Controller::Instance().SetMaxCPUMem(
+        uint64_t(memTotal*fMem)/(1024*1024)/iJobs
+      );
+      MESSAGE("Converting %u stacks at a time with up to %u MB RAM each",
+              iJobs, uint32_t(Controller::Instance().SysInfo()->
+                              GetMaxUsableCPUMem()/1024/1024));
+      // progress messages of concurrent jobs would overwrite each other,
+      // only warnings and errors are shown, and none of them may erase the
+      // line that another job printed before it
+      debugOut->SetOutput(true, true, false, false);
+      debugOut->SetClearOldMessage(false);
+    }
+
+    // large stacks first so a big one does not start last and leave the
+    // other jobs idle at the end
+    vector<size_t> vOrder(dirinfo.size());
+    for (size_t i = 0;i<vOrder.size();i++) vOrder[i] = i;
+    std::stable_sort(vOrder.begin(), vOrder.end(),
+                     [&](size_t a, size_t b) {
+                       return dirinfo[a]->m_Elements.size() >
+                              dirinfo[b]->m_Elements.size();
+                     });
+
+    vector<bool> vFailed(dirinfo.size(), false);
+    std::atomic<size_t> iNext(0);
+    std::mutex outMutex;
+    std::mutex setupMutex;
+    vector<std::thread> workers;
+    for (uint32_t t = 0;t<iJobs;t++) {
+      workers.push_back(std::thread([&]() {
+        // an IOManager registers its converters when it is created and
+        // frees them when it is destroyed, one job at a time does that
+        std::unique_lock<std::mutex> setup(setupMutex);
+        IOManager jobMan;
+        jobMan.SetCompression(compression);
+        jobMan.SetCompressionLevel(level);
+        jobMan.SetLayout(bricklayout);
+        setup.unlock();
+        // the conversions themselves share no converter; their scratch
+        // files are named after the target, which differs for every stack
+        for (size_t j = iNext++;j<vOrder.size();j = iNext++) {
+          const size_t i = vOrder[j];
+          const bool bOK =
+            jobMan.ConvertDataset(&*dirinfo[i], vStrFilenames[i],
+                                  SysTools::GetPath(vStrFilenames[i]),
+                                  bricksize, brickoverlap, false);
+          std::lock_guard<std::mutex> lock(outMutex);
+          vFailed[i] = !bOK;
+          cout << "\n" << vStrFilenames[i]
+               << (bOK ? ": Success.\n\n" : ": Conversion failed!\n\n");
+        }
+        setup.lock();
+      }));
+    }
+    for (size_t t = 0;t<workers.size();t++) workers[t].join();
+
+    size_t iFailCount = 0;
     for (size_t i = 0;i<dirinfo.size();i++) {
-      if (ioMan.ConvertDataset(&*dirinfo[i], vStrFilenames[i],
-                               SysTools::GetPath(vStrFilenames[i]),
-                               bricksize, brickoverlap, false)) {
-        cout << "\nSuccess.\n\n";
-      } else {
-        cout << "\nConversion failed!\n\n";
-        iFailCount++;
-        return EXIT_FAILURE_GENERAL_DIR;
-      }
+      if (!vFailed[i]) continue;
+      if (iFailCount == 0) cout << "\nFailed stacks:\n";
+      cout << "  " << dirinfo[i]->m_strDesc << " -> " << vStrFilenames[i]
+           << "\n";
+      iFailCount++;
     }
 
     if (iFailCount != 0)  {
       cout << endl << iFailCount << " out of " << dirinfo.size()
            << " stacks failed to convert properly.\n\n";
+      return EXIT_FAILURE_GENERAL_DIR;
+    }
+
+    return EXIT_SUCCESS;
+  }
+}
+
+// UVF to UVF: the volume is rebricked straight from the source bricks. Old
+// files without a TOC volume go through an intermediate nrrd file instead.
+static int
+rebrick_data(const IOManager& iom, const std::string& in,
+             const std::string& out, uint32_t bricksize,
+             uint32_t brickoverlap, uint32_t compression, uint32_t level,
+             uint32_t layout, uint64_t memory)
+{
+  cout << endl << "Running in UVF to UVF mode, rebricking " << in << " to "
+       << out << endl;
+  bool bNoTOCVolume;
+  if (RebrickUVF(in, out, bricksize, brickoverlap, compression, level,
+                 layout, memory, bNoTOCVolume)) {
+    cout << "\nSuccess.\n\n";
+    return EXIT_SUCCESS;
+  }
+  if (!bNoTOCVolume) {
+    cout << "\nUVF write failed.\n\n";
+    return EXIT_FAILURE_TO_UVF;
+  }
+
+  cout << "Step 1. Extracting raw data" << endl;
+  /// use some simple format as intermediate file
+  string tmpFile = SysTools::ChangeExt(out,"nrrd");
+
+  // HACK: use the output file's dir as temp dir
+  if (iom.ConvertDataset(in, tmpFile, SysTools::GetPath(tmpFile), true,
+                         bricksize, brickoverlap)) {
+    cout << endl << "Success." << endl << endl;
+  } else {
+    cout << endl << "Extraction failed!" << endl << endl;
+    return EXIT_FAILURE_TO_RAW;
+  }
+
+  cout << "Step 2. Writing new UVF file" << endl;
+  // HACK: use the output file's dir as temp dir
+  if (iom.ConvertDataset(tmpFile, out, SysTools::GetPath(out), true,
+                         bricksize, brickoverlap)) {
+    if(std::remove(tmpFile.c_str()) == -1) {
+     cout << endl << "Conversion succeeded but "
+          << " could not delete tmp file " << tmpFile << "\n\n";
+    } else {
+     cout << "\nSuccess.\n\n";
+    }
+    return EXIT_SUCCESS;
+  } else {
+    if(std::remove(tmpFile.c_str()) == -1) {
+     cout << "\nUVF write failed and could not delete tmp file "
+          << tmpFile << "\n\n";
+    } else {
+     cout << "\nUVF write failed.\n\n";
     }
+    return EXIT_FAILURE_TO_UVF;
+  }
+}
 
+// merges two or more volumes; UVF files are merged brick by brick, other
+// inputs go through the IOManager
+static int
+merge_data(const IOManager& iom, const std::vector<std::string>& in,
+           const std::vector<double>& scales,
+           const std::vector<double>& biases, const std::string& out,
+           uint32_t bricksize, uint32_t brickoverlap, uint32_t compression,
+           uint32_t level, uint32_t layout, uint64_t memory)
+{
+  const string targetType = SysTools::ToLowerCase(SysTools::GetExt(out));
+  if (iom.GetGeoConverterForExt(targetType, false, false) != NULL) {
+    std::cerr << "error: cannot convert volume to geometry\n";
+    return EXIT_FAILURE_CROSS_1;
+  }
+
+  bool bAllUVF = true;
+  for (size_t i = 0;i<in.size();i++) {
+    if (!iom.NeedsConversion(in[i])) { continue; }
+    bAllUVF = false;
+
+    const string sourceType = SysTools::ToLowerCase(SysTools::GetExt(in[i]));
+    if (iom.GetGeoConverterForExt(sourceType, false, true) != NULL) {
+      std::cerr << "error: Mesh merge not supported at the moment\n";
+      return EXIT_FAILURE_MESH_MERGE;
+    }
+    if (iom.GetConverterForExt(sourceType, false, true) == NULL) {
+      std::cerr << "error: Unknown file type for '" << in[i] << "'\n";
+      return i == 0 ? EXIT_FAILURE_UNKNOWN_1 : EXIT_FAILURE_UNKNOWN_2;
+    }
+  }
+
+  cout << endl << "Running in merge mode.\nConverting";
+  for (size_t i = 0;i<in.size();i++) {
+    cout << " " << in[i];
+  }
+  cout << " to " << out << "\n\n";
+
+  if (bAllUVF && targetType == "uvf") {
+    bool bNoTOCVolume;
+    if (MergeUVFs(in, scales, biases, out, bricksize, brickoverlap,
+                  compression, level, layout, memory, bNoTOCVolume)) {
+      cout << "\nSuccess.\n\n";
+      return EXIT_SUCCESS;
+    }
+    if (!bNoTOCVolume) {
+      cout << "\nMerging datasets failed!\n\n";
+      return EXIT_FAILURE_MERGE;
+    }
+  }
+
+  // HACK: use the output file's dir as temp dir
+  if (iom.MergeDatasets(in, scales, biases, out, SysTools::GetPath(out))) {
+    cout << "\nSuccess.\n\n";
     return EXIT_SUCCESS;
+  } else {
+    cout << "\nMerging datasets failed!\n\n";
+    return EXIT_FAILURE_MERGE;
   }
 }
 
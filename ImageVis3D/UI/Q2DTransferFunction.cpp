@@ -118,18 +118,20 @@ void Q2DTransferFunction::SetData(shared_ptr<const Histogram2D> vHistogram,
 
   // rescale the histogram to the [0..1] range
   // first find min and max ...
+  const size_t iArea = m_vHistogram.GetSize().area();
   unsigned int iMax = vHistogram->GetLinear(0);
   unsigned int iMin = iMax;
-  for (size_t i = 0;i<m_vHistogram.GetSize().area();i++) {
-    unsigned int iVal = vHistogram->GetLinear(i);
+  for (size_t i = 1;i<iArea;i++) {
+    const unsigned int iVal = vHistogram->GetLinear(i);
     if (iVal > iMax) iMax = iVal;
-    if (iVal < iMin) iMin = iVal;
+    else if (iVal < iMin) iMin = iVal;
   }
 
-  // ... than rescale
-  float fDiff = float(iMax)-float(iMin);
-  for (size_t i = 0;i<m_vHistogram.GetSize().area();i++)
-    m_vHistogram.SetLinear(i, (float(vHistogram->GetLinear(i)) - float(iMin)) / fDiff);
+  // ... than rescale, a constant histogram maps to zero
+  const float fDiff = float(iMax)-float(iMin);
+  const float fScale = fDiff > 0.0f ? 1.0f / fDiff : 0.0f;
+  for (size_t i = 0;i<iArea;i++)
+    m_vHistogram.SetLinear(i, (float(vHistogram->GetLinear(i)) - float(iMin)) * fScale);
 
   // Upload the new TF to the GPU.
   ss->cexec("tuvok.gpu.changed2DTrans", LuaClassInstance(), m_trans);
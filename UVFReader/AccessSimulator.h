@@ -0,0 +1,316 @@
+#ifndef ACCESSSIMULATOR_H
+#define ACCESSSIMULATOR_H
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "../Tuvok/StdTuvokDefines.h"
+#include "../Tuvok/Basics/Timer.h"
+#include "../Tuvok/Basics/Vectors.h"
+#include "../Tuvok/IO/UVF/UVF.h"
+#include "../Tuvok/IO/UVF/TOCBlock.h"
+
+#include "BrickTools.h"
+#include "BrickBenchmark.h"
+#include "UVFReport.h"
+
+// Synthetic brick request orders of a renderer, replayed against the TOC
+// offsets to compare the brick layouts (-l) a file can be written with.
+enum EAccessPattern {
+  AP_FRUSTUM_SWEEP = 0,  // camera orbits the volume, front to back per view
+  AP_SLICE_SCROLL,       // slice viewer scrolls through x, y and z
+  AP_LOD_REFINE,         // coarse to fine, the center of interest first
+  AP_COUNT
+};
+
+const char* AccessPatternName(size_t iPattern) {
+  switch (iPattern) {
+    case AP_FRUSTUM_SWEEP : return "frustum sweep";
+    case AP_SLICE_SCROLL  : return "slice scroll";
+    case AP_LOD_REFINE    : return "lod refinement";
+    default               : return "unknown";
+  }
+}
+
+struct AccessStats {
+  uint64_t iRequests;
+  uint64_t iStoredBytes;
+  uint64_t iDiscontiguous;  // reads not starting where the last one ended
+  uint64_t iSeekDistance;   // bytes skipped over, summed over all reads
+  uint64_t iMaxSeek;
+  bool     bReplayed;
+  bool     bCold;           // the page cache was dropped before the replay
+  double   fSeconds;        // wall clock time of the replay
+};
+
+struct AccessSimulation {
+  uint64_t iLoD;
+  uint64_t iViews;
+  std::vector<AccessStats> vPatterns;  // indexed by EAccessPattern
+};
+
+// center of a brick in voxel coordinates of its LoD
+DOUBLEVECTOR3 BrickCenter(const TOCBlock* toc, const UINT64VECTOR4& key) {
+  const UINT64VECTOR3 domain = toc->GetLODDomainSize(key.w);
+  const UINT64VECTOR3 count = toc->GetBrickCount(key.w);
+  return DOUBLEVECTOR3((key.x + 0.5) * double(domain.x) / double(count.x),
+                       (key.y + 0.5) * double(domain.y) / double(count.y),
+                       (key.z + 0.5) * double(domain.z) / double(count.z));
+}
+
+// same, scaled to the unit cube so centers of different LoDs line up
+DOUBLEVECTOR3 NormalizedBrickCenter(const TOCBlock* toc,
+                                    const UINT64VECTOR4& key) {
+  const UINT64VECTOR3 count = toc->GetBrickCount(key.w);
+  return DOUBLEVECTOR3((key.x + 0.5) / double(count.x),
+                       (key.y + 0.5) / double(count.y),
+                       (key.z + 0.5) / double(count.z));
+}
+
+void SortByDistance(const TOCBlock* toc, const DOUBLEVECTOR3& vPoint,
+                    bool bNormalized, std::vector<UINT64VECTOR4>& vBricks) {
+  std::vector<std::pair<double, UINT64VECTOR4>> vSorted;
+  vSorted.reserve(vBricks.size());
+  for (size_t i = 0;i<vBricks.size();i++) {
+    const DOUBLEVECTOR3 c = bNormalized
+                            ? NormalizedBrickCenter(toc, vBricks[i])
+                            : BrickCenter(toc, vBricks[i]);
+    vSorted.push_back(std::make_pair((c - vPoint).length(), vBricks[i]));
+  }
+  // ties are broken by LoD, coarse first, to keep the order deterministic
+  std::stable_sort(vSorted.begin(), vSorted.end(),
+                   [](const std::pair<double, UINT64VECTOR4>& a,
+                      const std::pair<double, UINT64VECTOR4>& b) {
+                     if (a.first != b.first) return a.first < b.first;
+                     return a.second.w > b.second.w;
+                   });
+  for (size_t i = 0;i<vSorted.size();i++) vBricks[i] = vSorted[i].second;
+}
+
+// iViews cameras on a circle around the volume, each looking at the
+// center with a narrow field of view so only part of the volume is hit.
+// Every view requests its bricks front to back; there is no brick cache
+// between views, so the worst case of a renderer is simulated.
+std::vector<UINT64VECTOR4> FrustumSweep(const TOCBlock* toc, uint64_t iLoD,
+                                        uint64_t iViews) {
+  const std::vector<UINT64VECTOR4> vAll = LoDBricks(toc, iLoD);
+  const UINT64VECTOR3 domain = toc->GetLODDomainSize(iLoD);
+  const DOUBLEVECTOR3 vCenter(domain.x/2.0, domain.y/2.0, domain.z/2.0);
+  const double fRadius = 1.5 * vCenter.length();
+  const double fCosHalfAngle = cos(20.0 * 3.14159265358979 / 180.0);
+
+  std::vector<UINT64VECTOR4> vRequests;
+  for (uint64_t v = 0;v<iViews;v++) {
+    // tilted orbit, so the views are not all aligned with one brick axis
+    const double fAngle = 2.0 * 3.14159265358979 * double(v) / double(iViews);
+    const DOUBLEVECTOR3 vEye = vCenter +
+      DOUBLEVECTOR3(cos(fAngle), 0.5 * sin(fAngle), sin(fAngle)) * fRadius;
+    DOUBLEVECTOR3 vView = vCenter - vEye;
+    vView.normalize();
+
+    std::vector<UINT64VECTOR4> vVisible;
+    for (size_t i = 0;i<vAll.size();i++) {
+      DOUBLEVECTOR3 vToBrick = BrickCenter(toc, vAll[i]) - vEye;
+      vToBrick.normalize();
+      if ((vToBrick ^ vView) >= fCosHalfAngle) vVisible.push_back(vAll[i]);
+    }
+    SortByDistance(toc, vEye, false, vVisible);
+    vRequests.insert(vRequests.end(), vVisible.begin(), vVisible.end());
+  }
+  return vRequests;
+}
+
+// One brick layer at a time along x, then y, then z, each layer in row
+// order; a layer covers all slices the viewer shows while crossing it.
+std::vector<UINT64VECTOR4> SliceScroll(const TOCBlock* toc, uint64_t iLoD) {
+  const UINT64VECTOR3 count = toc->GetBrickCount(iLoD);
+  std::vector<UINT64VECTOR4> vRequests;
+  for (int iAxis = 0;iAxis<3;iAxis++) {
+    const uint64_t iLayers = count[iAxis];
+    const uint64_t iRows = count[(iAxis+2)%3];
+    const uint64_t iColumns = count[(iAxis+1)%3];
+    for (uint64_t l = 0;l<iLayers;l++)
+      for (uint64_t r = 0;r<iRows;r++)
+        for (uint64_t c = 0;c<iColumns;c++) {
+          UINT64VECTOR4 key(0, 0, 0, iLoD);
+          key[iAxis] = l;
+          key[(iAxis+1)%3] = c;
+          key[(iAxis+2)%3] = r;
+          vRequests.push_back(key);
+        }
+  }
+  return vRequests;
+}
+
+// All LoDs from the coarsest down to iLoD, within a LoD the bricks closest
+// to the center of the volume first, as a progressive renderer refines.
+std::vector<UINT64VECTOR4> LoDRefinement(const TOCBlock* toc,
+                                         uint64_t iLoD) {
+  std::vector<UINT64VECTOR4> vRequests;
+  for (uint64_t lod = toc->GetLoDCount();lod-- > iLoD;) {
+    std::vector<UINT64VECTOR4> vBricks = LoDBricks(toc, lod);
+    SortByDistance(toc, DOUBLEVECTOR3(0.5, 0.5, 0.5), true, vBricks);
+    vRequests.insert(vRequests.end(), vBricks.begin(), vBricks.end());
+  }
+  return vRequests;
+}
+
+// Seek statistics of a request order, from the TOC offsets alone.
+AccessStats MeasureAccesses(const TOCBlock* toc,
+                            const std::vector<UINT64VECTOR4>& vRequests) {
+  AccessStats s = {0, 0, 0, 0, 0, false, false, 0.0};
+  uint64_t iEnd = 0;
+  for (size_t i = 0;i<vRequests.size();i++) {
+    const TOCEntry& te = toc->GetBrickInfo(vRequests[i]);
+    s.iRequests++;
+    s.iStoredBytes += te.m_iLength;
+    if (i > 0 && te.m_iOffset != iEnd) {
+      const uint64_t iSeek = te.m_iOffset > iEnd ? te.m_iOffset - iEnd
+                                                 : iEnd - te.m_iOffset;
+      s.iDiscontiguous++;
+      s.iSeekDistance += iSeek;
+      s.iMaxSeek = std::max(s.iMaxSeek, iSeek);
+    }
+    iEnd = te.m_iOffset + te.m_iLength;
+  }
+  return s;
+}
+
+// Loads the requests in order on one thread, as the renderer would, and
+// stores the wall clock time in s. The bandwidth includes decompression.
+void ReplayAccesses(const std::string& strUVFName, const TOCBlock* toc,
+                    const std::vector<UINT64VECTOR4>& vRequests,
+                    AccessStats& s) {
+  s.bCold = DropFileCache(strUVFName);
+  if (!s.bCold)
+    WARNING("Unable to drop the file cache, the replay may be warm");
+
+  std::vector<uint8_t> data;
+  Timer timer;
+  timer.Start();
+  for (size_t i = 0;i<vRequests.size();i++) {
+    data.resize(BrickBytes(toc, vRequests[i]));
+    toc->GetData(data.data(), vRequests[i]);
+  }
+  s.fSeconds = timer.Elapsed()/1000.0;
+  s.bReplayed = true;
+}
+
+bool SimulateAccessPatterns(const std::string& strUVFName, uint64_t iLoD,
+                            uint64_t iViews, bool bReplay,
+                            AccessSimulation& sim, std::string& strProblem) {
+  const std::wstring wstrUVFName(strUVFName.begin(), strUVFName.end());
+  UVF uvfFile(wstrUVFName);
+  if (!uvfFile.Open(false, false, false, &strProblem)) return false;
+  const TOCBlock* toc = FindTOCBlock(uvfFile);
+  if (!toc || iLoD >= toc->GetLoDCount()) {
+    strProblem = toc ? "level of detail out of range"
+                     : "file has no TOC block";
+    uvfFile.Close();
+    return false;
+  }
+
+  sim.iLoD = iLoD;
+  sim.iViews = std::max<uint64_t>(1, iViews);
+  sim.vPatterns.clear();
+  for (size_t p = 0;p<AP_COUNT;p++) {
+    std::vector<UINT64VECTOR4> vRequests;
+    switch (p) {
+      case AP_FRUSTUM_SWEEP :
+        vRequests = FrustumSweep(toc, iLoD, sim.iViews);
+        break;
+      case AP_SLICE_SCROLL :
+        vRequests = SliceScroll(toc, iLoD);
+        break;
+      case AP_LOD_REFINE :
+        vRequests = LoDRefinement(toc, iLoD);
+        break;
+    }
+    MESSAGE("Simulating %s with %llu requests", AccessPatternName(p),
+            static_cast<unsigned long long>(vRequests.size()));
+    AccessStats s = MeasureAccesses(toc, vRequests);
+    if (bReplay) ReplayAccesses(strUVFName, toc, vRequests, s);
+    sim.vPatterns.push_back(s);
+  }
+  uvfFile.Close();
+  return true;
+}
+
+void PrintAccessSimulation(const std::string& strUVFName,
+                           const AccessSimulation& sim, std::ostream& out) {
+  out << "Access simulation of " << strUVFName << ", LoD " << sim.iLoD
+      << ", " << sim.iViews << " view(s)\n";
+  for (size_t p = 0;p<sim.vPatterns.size();p++) {
+    const AccessStats& s = sim.vPatterns[p];
+    out << "  " << AccessPatternName(p) << ": " << s.iRequests
+        << " requests, " << s.iStoredBytes << " bytes, "
+        << s.iDiscontiguous << " discontiguous reads, seek distance "
+        << s.iSeekDistance << " bytes (max " << s.iMaxSeek << ", mean "
+        << (s.iDiscontiguous ? s.iSeekDistance / s.iDiscontiguous : 0)
+        << ")\n";
+    if (s.bReplayed)
+      out << "    " << (s.bCold ? "cold" : "warm") << " replay in "
+          << s.fSeconds << " s, "
+          << MBPerSecond(s.iStoredBytes, s.fSeconds) << " MB/s\n";
+  }
+  out.flush();
+}
+
+void ReportAccessSimulation(const std::string& strUVFName,
+                            const AccessSimulation& sim, ReportWriter& r) {
+  r.BeginObject(strUVFName);
+  r.Value("file", strUVFName);
+  r.Value("lod", sim.iLoD);
+  r.Value("views", sim.iViews);
+  r.BeginArray("patterns");
+  for (size_t p = 0;p<sim.vPatterns.size();p++) {
+    const AccessStats& s = sim.vPatterns[p];
+    r.BeginObject();
+    r.Value("pattern", AccessPatternName(p));
+    r.Value("requests", s.iRequests);
+    r.Value("stored_bytes", s.iStoredBytes);
+    r.Value("discontiguous_reads", s.iDiscontiguous);
+    r.Value("seek_distance", s.iSeekDistance);
+    r.Value("max_seek", s.iMaxSeek);
+    if (s.bReplayed) {
+      r.Value("cache", s.bCold ? "cold" : "warm");
+      r.Value("seconds", s.fSeconds);
+      r.Value("mb_per_second", MBPerSecond(s.iStoredBytes, s.fSeconds));
+    }
+    r.EndObject();
+  }
+  r.EndArray();
+  r.EndObject();
+}
+
+#endif // ACCESSSIMULATOR_H
+
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2012 Interactive Visualization and Data Analysis Group
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
@@ -10,6 +10,7 @@
 
 #include "../Tuvok/StdTuvokDefines.h"
 #include "../Tuvok/Controller/Controller.h"
+#include "../Tuvok/Basics/SysTools.h"
 
 #include "../Tuvok/IO/IOManager.h"
 // #include "../Tuvok/IO/TuvokSizes.h"
@@ -22,261 +23,427 @@
 #include "../Tuvok/IO/UVF/KeyValuePairDataBlock.h"
 #include "../Tuvok/IO/UVF/GeometryDataBlock.h"
 
+#include "ParallelTools.h"
+#include "UVFChecksum.h"
+#include "UVFReport.h"
+#include "VolumeDump.h"
+
 using namespace std;
 
-void PrintGeneralBlockInfo(const DataBlock* b, uint64_t i) {
-  cout << "    Block " << i << ": " << b->strBlockID
-        << endl
+void PrintGeneralBlockInfo(const DataBlock* b, uint64_t i, std::ostream& out) {
+  out << "    Block " << i << ": " << b->strBlockID
+        << "\n"
         << "      Data is of type: "
         << UVFTables::BlockSemanticTableToCharString(b->GetBlockSemantic())
-        << endl
+        << "\n"
         << "      Global Block Compression is : "
         << UVFTables::CompressionSemanticToCharString(b->ulCompressionScheme)
-        << endl;
+        << "\n";
+}
+
+// Minimum, median, 99th percentile and maximum of a set of values.
+struct Distribution {
+  uint64_t iCount;
+  double   fMin;
+  double   fMedian;
+  double   fP99;
+  double   fMax;
+};
+
+// Reorders the values.
+Distribution Distribute(std::vector<double>& v) {
+  Distribution d = {uint64_t(v.size()), 0.0, 0.0, 0.0, 0.0};
+  if (v.empty()) return d;
+
+  const size_t iMedian = (v.size()-1)/2;
+  const size_t iP99 = size_t(double(v.size()-1)*0.99);
+  std::nth_element(v.begin(), v.begin()+iMedian, v.end());
+  d.fMedian = v[iMedian];
+  // the top percent is behind the median now
+  std::nth_element(v.begin()+iMedian, v.begin()+iP99, v.end());
+  d.fP99 = v[iP99];
+  d.fMin = *std::min_element(v.begin(), v.begin()+iMedian+1);
+  d.fMax = *std::max_element(v.begin()+iP99, v.end());
+  return d;
+}
+
+// Brick statistics of one level of detail of a TOC block. Bricks are
+// counted per codec, the last entry collects unknown codecs. The offset
+// gap of a brick is the number of bytes between its end and the start of
+// the brick that follows it in the file, whatever its LoD.
+struct LODSummary {
+  enum { CODEC_COUNT = 7 };
+
+  UINT64VECTOR3 vDomainSize;
+  UINT64VECTOR3 vBrickCount;
+  uint64_t iCompressedBytes;
+  uint64_t iUncompressedBytes;
+  uint64_t iCodecBricks[CODEC_COUNT];
+  Distribution storedBytes;
+  Distribution ratio;
+  Distribution offsetGap;
+
+  double CompressionRatio() const {
+    return iCompressedBytes > 0
+           ? double(iUncompressedBytes)/double(iCompressedBytes) : 0.0;
+  }
+};
+
+// Number of empty (all zero) and constant (one non-zero value) bricks of
+// one level of detail, only known after the bricks have been decoded.
+struct BrickContent {
+  uint64_t iEmpty;
+  uint64_t iConstant;
+};
+
+const char* CodecName(size_t iCodec) {
+  static const char* const names[LODSummary::CODEC_COUNT] = {
+    "none", "zlib", "lzma", "lz4", "bzlib", "lzham", "other"
+  };
+  return names[std::min<size_t>(iCodec, LODSummary::CODEC_COUNT-1)];
+}
+
+size_t CodecIndex(COMPRESSION_TYPE eCompression) {
+  switch (eCompression) {
+    case CT_NONE  : return 0;
+    case CT_ZLIB  : return 1;
+    case CT_LZMA  : return 2;
+    case CT_LZ4   : return 3;
+    case CT_BZLIB : return 4;
+    case CT_LZHAM : return 5;
+    default       : return LODSummary::CODEC_COUNT-1;
+  }
+}
+
+// Walks over the TOC of every LoD. The TOC is held in memory, so the
+// entries are looked up in parallel.
+std::vector<LODSummary> SummarizeTOC(const TOCBlock* b) {
+  // EnumerateBricks returns the bricks of each LoD as one run, the per
+  // LoD sums below walk these runs
+  const std::vector<UINT64VECTOR4> vBricks = EnumerateBricks(b);
+  const int64_t iCount = int64_t(vBricks.size());
+  const uint64_t iVoxelBytes = b->GetComponentTypeSize() *
+                               b->GetComponentCount();
+
+  std::vector<uint64_t> vOffset(vBricks.size());
+  std::vector<uint64_t> vStored(vBricks.size());
+  std::vector<uint64_t> vUncompressed(vBricks.size());
+  std::vector<uint8_t>  vCodec(vBricks.size());
+  #pragma omp parallel for schedule(static)
+  for (int64_t i = 0;i<iCount;i++) {
+    const TOCEntry& te = b->GetBrickInfo(vBricks[size_t(i)]);
+    vOffset[size_t(i)] = te.m_iOffset;
+    vStored[size_t(i)] = te.m_iLength;
+    vCodec[size_t(i)] = uint8_t(CodecIndex(te.m_eCompression));
+    vUncompressed[size_t(i)] = b->GetBrickSize(vBricks[size_t(i)]).volume() *
+                               iVoxelBytes;
+  }
+
+  // bricks in file order give the gaps, the last brick has none
+  std::vector<size_t> vOrder(vBricks.size());
+  for (size_t i = 0;i<vOrder.size();i++) vOrder[i] = i;
+  std::sort(vOrder.begin(), vOrder.end(), [&](size_t x, size_t y) {
+    return vOffset[x] < vOffset[y];
+  });
+  std::vector<std::vector<double>> vGaps(size_t(b->GetLoDCount()));
+  for (size_t i = 0;i+1<vOrder.size();i++) {
+    const size_t j = vOrder[i];
+    vGaps[size_t(vBricks[j].w)].push_back(
+      double(int64_t(vOffset[vOrder[i+1]] - (vOffset[j] + vStored[j]))));
+  }
+
+  std::vector<LODSummary> vSummary(size_t(b->GetLoDCount()));
+  size_t iFirst = 0;
+  for (uint64_t lod = 0;lod<b->GetLoDCount();lod++) {
+    LODSummary& s = vSummary[size_t(lod)];
+    s.vDomainSize = b->GetLODDomainSize(lod);
+    s.vBrickCount = b->GetBrickCount(lod);
+    s.iCompressedBytes = 0;
+    s.iUncompressedBytes = 0;
+    std::fill(s.iCodecBricks, s.iCodecBricks+LODSummary::CODEC_COUNT, 0);
+
+    const size_t iEnd = iFirst + size_t(s.vBrickCount.volume());
+    std::vector<double> vStoredLoD, vRatio;
+    vStoredLoD.reserve(iEnd-iFirst);
+    vRatio.reserve(iEnd-iFirst);
+    for (size_t i = iFirst;i<iEnd;i++) {
+      s.iCodecBricks[vCodec[i]]++;
+      s.iCompressedBytes += vStored[i];
+      s.iUncompressedBytes += vUncompressed[i];
+      vStoredLoD.push_back(double(vStored[i]));
+      if (vStored[i] > 0)
+        vRatio.push_back(double(vUncompressed[i])/double(vStored[i]));
+    }
+    s.storedBytes = Distribute(vStoredLoD);
+    s.ratio = Distribute(vRatio);
+    s.offsetGap = Distribute(vGaps[size_t(lod)]);
+    iFirst = iEnd;
+  }
+  return vSummary;
+}
+
+// Decodes every brick of the first TOC block on iWorkers threads and counts
+// the empty and constant ones per LoD.
+bool ScanBrickContents(const std::string& strUVFName, unsigned int iWorkers,
+                       std::vector<BrickContent>& vContent,
+                       std::string& strProblem) {
+  std::vector<UINT64VECTOR4> vBricks;
+  uint64_t iVoxelBytes = 0;
+  {
+    wstring wstrUVFName(strUVFName.begin(), strUVFName.end());
+    UVF uvfFile(wstrUVFName);
+    if (!uvfFile.Open(false, false, false, &strProblem)) return false;
+    const TOCBlock* toc = FindTOCBlock(uvfFile);
+    if (!toc) {
+      strProblem = "file has no TOC block";
+      uvfFile.Close();
+      return false;
+    }
+    vBricks = EnumerateBricks(toc);
+    iVoxelBytes = toc->GetComponentTypeSize() * toc->GetComponentCount();
+    vContent.assign(size_t(toc->GetLoDCount()), BrickContent());
+    uvfFile.Close();
+  }
+  for (size_t i = 0;i<vContent.size();i++) {
+    vContent[i].iEmpty = 0;
+    vContent[i].iConstant = 0;
+  }
+
+  std::mutex m;
+  return ForEachBrick(strUVFName, vBricks, iWorkers,
+    [&](unsigned int, size_t i, const TOCBlock*,
+        const std::vector<uint8_t>& data) {
+      const size_t iVoxel = size_t(iVoxelBytes);
+      bool bConstant = true;
+      for (size_t j = iVoxel;j<data.size() && bConstant;j+=iVoxel)
+        bConstant = memcmp(&data[0], &data[j], iVoxel) == 0;
+      if (!bConstant) return;
+
+      bool bEmpty = true;
+      for (size_t j = 0;j<iVoxel && j<data.size() && bEmpty;j++)
+        bEmpty = data[j] == 0;
+
+      std::lock_guard<std::mutex> lock(m);
+      if (bEmpty)
+        vContent[size_t(vBricks[i].w)].iEmpty++;
+      else
+        vContent[size_t(vBricks[i].w)].iConstant++;
+    }, strProblem);
+}
+
+void PrintDistribution(const char* strLabel, const Distribution& d,
+                       std::ostream& out) {
+  if (d.iCount == 0) return;
+  out << "            " << strLabel << ": min " << d.fMin
+      << " / median " << d.fMedian << " / p99 " << d.fP99
+      << " / max " << d.fMax << "\n";
 }
 
-void PrintToCBlockInfo(const TOCBlock* b) {
+void PrintToCBlockInfo(const TOCBlock* b,
+                       const std::vector<BrickContent>& vContent,
+                       std::ostream& out, std::ostream& err) {
   if (!b) {
-    cerr << "Block cast error" << endl;
+    err << "Block cast error\n";
     return;
   }
 
-  cout << "      Volume Information: " << endl
-        << "        Level of detail: " << b->GetLoDCount() << endl
+  out << "      Volume Information: \n"
+        << "        Level of detail: " << b->GetLoDCount() << "\n"
         << "        Max Bricksize: (" << b->GetMaxBrickSize().x << " x "
                                       << b->GetMaxBrickSize().y << " x "
-                                      << b->GetMaxBrickSize().z << ")" << endl;
+                                      << b->GetMaxBrickSize().z << ")\n";
+  const std::vector<LODSummary> vSummary = SummarizeTOC(b);
   for (uint64_t i=0;i<b->GetLoDCount();++i) {
-    cout << "          Level " << i << " size:" << b->GetLODDomainSize(i).x <<
-                                            "x" << b->GetLODDomainSize(i).y <<
-                                            "x" << b->GetLODDomainSize(i).z <<
-                                            endl;
+    const LODSummary& s = vSummary[size_t(i)];
+    out << "          Level " << i << " size:" << s.vDomainSize.x <<
+                                            "x" << s.vDomainSize.y <<
+                                            "x" << s.vDomainSize.z <<
+                                            "\n";
     
-    UINT64VECTOR3 brickCount = b->GetBrickCount(i);
-    cout << "            Bricks: " << brickCount.x << 
-                               "x" << brickCount.y << 
-                               "x" << brickCount.z;
-
-    uint64_t iCompressionNone = 0;
-    uint64_t iCompressionZLIB = 0;
-    uint64_t iCompressionLZMA = 0;
-    uint64_t iCompressionLZ4 = 0;
-    uint64_t iCompressionBZLIB = 0;
-    uint64_t iCompressionLZHAM = 0;
-    uint64_t iCompressionOther = 0;
-
-    for (uint64_t bz=0;bz<brickCount.z;++bz) {
-      for (uint64_t by=0;by<brickCount.y;++by) {
-        for (uint64_t bx=0;bx<brickCount.x;++bx) {
-          const TOCEntry& te = b->GetBrickInfo(UINT64VECTOR4(bx,by,bz,i));
-
-          switch (te.m_eCompression) {
-            case CT_NONE  : iCompressionNone++; break;
-            case CT_ZLIB  : iCompressionZLIB++; break;
-            case CT_LZMA  : iCompressionLZMA++; break;
-            case CT_LZ4   : iCompressionLZ4++; break;
-            case CT_BZLIB : iCompressionBZLIB++; break;
-            case CT_LZHAM : iCompressionLZHAM++; break;
-            default : iCompressionOther++; break;
-          }
-        }
-      }
-    }
-    cout << " (";
-    if (iCompressionNone) cout << " Uncompressed:" << iCompressionNone;
-    if (iCompressionZLIB) cout <<" ZLIB:" << iCompressionZLIB;
-    if (iCompressionLZMA) cout <<" LZMA:" << iCompressionLZMA;
-    if (iCompressionLZ4) cout <<" LZ4:" << iCompressionLZ4;
-    if (iCompressionBZLIB) cout <<" BZLIB:" << iCompressionBZLIB;
-    if (iCompressionLZHAM) cout <<" LZHAM:" << iCompressionLZHAM;
-    if (iCompressionOther) cout <<" Other:" << iCompressionOther;
-    cout << " )" << endl;
+    out << "            Bricks: " << s.vBrickCount.x << 
+                               "x" << s.vBrickCount.y << 
+                               "x" << s.vBrickCount.z;
 
+    static const char* const labels[LODSummary::CODEC_COUNT] = {
+      "Uncompressed", "ZLIB", "LZMA", "LZ4", "BZLIB", "LZHAM", "Other"
+    };
+    out << " (";
+    for (size_t c = 0;c<LODSummary::CODEC_COUNT;c++)
+      if (s.iCodecBricks[c])
+        out << " " << labels[c] << ":" << s.iCodecBricks[c];
+    out << " )\n";
+    out << "            Size: " << s.iCompressedBytes << " bytes stored, "
+        << s.iUncompressedBytes << " bytes uncompressed (ratio "
+        << s.CompressionRatio() << ":1)\n";
+    PrintDistribution("Stored bytes per brick", s.storedBytes, out);
+    PrintDistribution("Compression ratio", s.ratio, out);
+    PrintDistribution("Offset gap in bytes", s.offsetGap, out);
+    if (i < vContent.size())
+      out << "            Empty bricks: " << vContent[size_t(i)].iEmpty
+          << ", constant bricks: " << vContent[size_t(i)].iConstant << "\n";
   }
 }
 
-void PrintRDBlockInfo(const RasterDataBlock* b, bool bShowData) {
+// With bShowData the finest LoD is flattened into strTempFile and printed.
+void PrintRDBlockInfo(const RasterDataBlock* b, bool bShowData,
+                      const std::string& strTempFile,
+                      std::ostream& out, std::ostream& err) {
   if (!b) {
-    cerr << "Block cast error" << endl;
+    err << "Block cast error\n";
     return;
   }
 
-  cout << "      Volume Information: " << endl
+  out << "      Volume Information: \n"
         << "        Semantics:";
   for (size_t j=0; j < b->ulDomainSemantics.size(); j++) {
-    cout << " " << DomainSemanticToCharString(b->ulDomainSemantics[j]).c_str();
+    out << " " << DomainSemanticToCharString(b->ulDomainSemantics[j]).c_str();
   }
-  cout << endl
+  out << "\n"
         << "        Levels of detail: "
-        << b->ulLODDecFactor.size() << endl
+        << b->ulLODDecFactor.size() << "\n"
         << "        Size:";
   for (size_t j = 0;j<b->ulDomainSemantics.size();j++) {
-    cout << " " << b->ulDomainSize[j];
+    out << " " << b->ulDomainSize[j];
   }
-  cout << endl
+  out << "\n"
         << "        Data:";
   for (size_t j = 0;j<b->ulElementDimension;j++) {
     for (size_t k = 0;k<b->ulElementDimensionSize[j];k++) {
-      cout << " "
+      out << " "
             << UVFTables::ElementSemanticTableToCharString(
                                 b->ulElementSemantic[j][k]).c_str();
     }
-    cout << endl
+    out << "\n"
           << "        Transformation:\n";
     size_t ulTransformDimension = b->ulDomainSemantics.size()+1;
     if (ulTransformDimension * ulTransformDimension !=
         b->dDomainTransformation.size()) {
-      cerr << "      error in domain transformation: " << endl;
+      err << "      error in domain transformation: \n";
       return;
     }
     size_t jj = 0;
     for (size_t y = 0;y<ulTransformDimension;y++) {
-      cout << "        ";
+      out << "        ";
       for (size_t x = 0;x<ulTransformDimension;x++) {
-        cout << " " << b->dDomainTransformation[jj++];
+        out << " " << b->dDomainTransformation[jj++];
       }
-      cout << endl;
+      out << "\n";
     }
   }
   if(bShowData) {
-    std::cout << "        raw data:\n";
-
-    uint64_t bit_width = b->ulElementBitSize[0][0];
-    const bool is_signed = b->bSignedElement[0][0];
-    const bool is_float = bit_width != b->ulElementMantissa[0][0];
-    if(is_float && bit_width == 32) {
-      std::copy(LODBrickIterator<float, FINEST_RESOLUTION>(b),
-                LODBrickIterator<float, FINEST_RESOLUTION>(),
-                std::ostream_iterator<float>(std::cout, " "));
-    } else if(is_float && bit_width == 64) {
-      std::copy(LODBrickIterator<double, FINEST_RESOLUTION>(b),
-                LODBrickIterator<double, FINEST_RESOLUTION>(),
-                std::ostream_iterator<double>(std::cout, " "));
-    } else if(!is_signed && bit_width ==  8) {
-      // note for this and uint8 we use "int", but only in the output
-      // iterator -- otherwise the stream interprets it as character
-      // data and outputs garbage.
-      std::copy(LODBrickIterator<uint8_t, FINEST_RESOLUTION>(b),
-                LODBrickIterator<uint8_t, FINEST_RESOLUTION>(),
-                std::ostream_iterator<int>(std::cout, " "));
-    } else if( is_signed && bit_width ==  8) {
-      std::copy(LODBrickIterator<int8_t, FINEST_RESOLUTION>(b),
-                LODBrickIterator<int8_t, FINEST_RESOLUTION>(),
-                std::ostream_iterator<int>(std::cout, " "));
-    } else if(!is_signed && bit_width == 16) {
-      std::copy(LODBrickIterator<uint16_t, FINEST_RESOLUTION>(b),
-                LODBrickIterator<uint16_t, FINEST_RESOLUTION>(),
-                std::ostream_iterator<uint16_t>(std::cout, " "));
-    } else if( is_signed && bit_width == 16) {
-      std::copy(LODBrickIterator<int16_t, FINEST_RESOLUTION>(b),
-                LODBrickIterator<int16_t, FINEST_RESOLUTION>(),
-                std::ostream_iterator<int16_t>(std::cout, " "));
-    } else if(!is_signed && bit_width == 32) {
-      std::copy(LODBrickIterator<uint32_t, FINEST_RESOLUTION>(b),
-                LODBrickIterator<uint32_t, FINEST_RESOLUTION>(),
-                std::ostream_iterator<uint32_t>(std::cout, " "));
-    } else if( is_signed && bit_width == 32) {
-      std::copy(LODBrickIterator<int32_t, FINEST_RESOLUTION>(b),
-                LODBrickIterator<int32_t, FINEST_RESOLUTION>(),
-                std::ostream_iterator<int32_t>(std::cout, " "));
-    } else {
-      T_ERROR("Unsupported data type!");
-    }
-    std::cout << "\n";
+    out << "        raw data:\n";
+    const DumpRegion all = {UINT64VECTOR3(0, 0, 0), UINT64VECTOR3(0, 0, 0)};
+    std::string strProblem;
+    if (!DumpRasterBlock(b, 0, all, DF_TEXT, out, strTempFile, strProblem))
+      err << "Unable to display the data: " << strProblem << "\n";
   }
 }
 
-void PrintKVPBlockInfo(const KeyValuePairDataBlock* b) {
+void PrintKVPBlockInfo(const KeyValuePairDataBlock* b,
+                       std::ostream& out, std::ostream& err) {
   if (!b) {
-    cerr << "Block cast error" << endl;
+    err << "Block cast error\n";
     return;
   }
 
-  cout << "      Data size: " << b->ComputeDataSize() << "\n"
-        << "      Values (" << b->GetKeyCount() << "): " << endl;
+  out << "      Data size: " << b->ComputeDataSize() << "\n"
+        << "      Values (" << b->GetKeyCount() << "): \n";
 
   for (size_t i = 0;i<b->GetKeyCount();i++) {
-    cout << "        " << b->GetKeyByIndex(i).c_str() << " -> "
-          << b->GetValueByIndex(i).c_str() << endl;
+    out << "        " << b->GetKeyByIndex(i).c_str() << " -> "
+          << b->GetValueByIndex(i).c_str() << "\n";
+  }
+}
+
+// Number of bins up to and including the last non-empty one.
+size_t FilledSize(const Histogram1DDataBlock* b) {
+  const std::vector<uint64_t>& vHist = b->GetHistogram();
+  size_t iFilledSize = vHist.size();
+  while (iFilledSize > 0 && vHist[iFilledSize-1] == 0) iFilledSize--;
+  return iFilledSize;
+}
+
+// Extent of the non-empty part of a 2D histogram, in bins.
+VECTOR2<size_t> FilledSize(const Histogram2DDataBlock* b) {
+  VECTOR2<size_t> vSize(0,0);
+  for (size_t j = 0;j<b->GetHistogram().size();j++) {
+    for (size_t i = 0;i<b->GetHistogram()[j].size();i++) {
+      if ( b->GetHistogram()[j][i] != 0) {
+        if ((i+1) > vSize.y) {
+          vSize.y = i+1;
+        }
+        vSize.x = j+1;
+      }
+    }
   }
+  return vSize;
 }
 
-void PrintH1DBlockInfo(const Histogram1DDataBlock* b, bool bShow1dhist) {
+void PrintH1DBlockInfo(const Histogram1DDataBlock* b, bool bShow1dhist,
+                       std::ostream& out, std::ostream& err) {
   if (!b) {
-    cerr << "Block cast error" << endl;
+    err << "Block cast error\n";
     return;
   }
 
-  size_t iFilledSize = 0;
-  for (size_t i = 0;i<b->GetHistogram().size();i++) {
-    if ( b->GetHistogram()[i] != 0) {
-      iFilledSize = i+1;
-    }
-  }
-  cout << "      Filled size: " << iFilledSize << endl;
+  const size_t iFilledSize = FilledSize(b);
+  out << "      Filled size: " << iFilledSize << "\n";
   if (bShow1dhist) {
-    cout << "      Entries: " << endl;
+    out << "      Entries: \n";
     for (size_t i = 0;i<iFilledSize;i++) {
-      cout << i << ":" << b->GetHistogram()[i] << " ";
+      out << i << ":" << b->GetHistogram()[i] << " ";
     }
-    cout <<  endl;
+    out << "\n";
   }
 }
 
-void PrintH2DBlockInfo(const Histogram2DDataBlock* b, bool bShow2dhist) {
+void PrintH2DBlockInfo(const Histogram2DDataBlock* b, bool bShow2dhist,
+                       std::ostream& out, std::ostream& err) {
   if (!b) {
-    cerr << "Block cast error" << endl;
+    err << "Block cast error\n";
     return;
   }
 
-  VECTOR2<size_t> vSize(0,0);
-  for (size_t j = 0;j<b->GetHistogram().size();j++) {
-    for (size_t i = 0;i<b->GetHistogram()[j].size();i++) {
-      if ( b->GetHistogram()[j][i] != 0) {
-        if ((i+1) > vSize.y) {
-          vSize.y = i+1;
-        }
-        vSize.x = j+1;
-      }
-    }
-  }
-  cout << "      Filled size: " << vSize.x << " x " << vSize.y << endl;
+  const VECTOR2<size_t> vSize = FilledSize(b);
+  out << "      Filled size: " << vSize.x << " x " << vSize.y << "\n";
   if (bShow2dhist) {
-    cout << "      Entries: " << endl;
+    out << "      Entries: \n";
     for (size_t j = 0; j < vSize.y; j++) {
       for (size_t i = 0; i < vSize.x; i++) {
-        cout << i << "/" << j << ":" << b->GetHistogram()[i][j] << "\n";
+        out << i << "/" << j << ":" << b->GetHistogram()[i][j] << "\n";
       }
     }
-    cout << endl;
+    out << "\n";
   }
 }
 
-void PrintMaxMinBlockInfo(const MaxMinDataBlock* b) {
+void PrintMaxMinBlockInfo(const MaxMinDataBlock* b,
+                          std::ostream& out, std::ostream& err) {
   if (!b) {
-    cerr << "Block cast error" << endl;
+    err << "Block cast error\n";
     return;
   }
 
   for (size_t i = 0;i<b->GetComponentCount();++i) {
     if (b->GetComponentCount() > 1) 
-      cout << "      Component " << i << ":\n";
-    cout << "      Minimum: " << b->GetGlobalValue(i).minScalar << "\n";
-    cout << "      Maximum: " << b->GetGlobalValue(i).maxScalar << "\n";
-    cout << "      "
+      out << "      Component " << i << ":\n";
+    out << "      Minimum: " << b->GetGlobalValue(i).minScalar << "\n";
+    out << "      Maximum: " << b->GetGlobalValue(i).maxScalar << "\n";
+    out << "      "
             "Min Gradient: " << b->GetGlobalValue(i).minGradient << "\n";
-    cout << "      "
+    out << "      "
             "Max Gradient: " << b->GetGlobalValue(i).maxGradient << "\n";
   }
 }
 
-void PrintGeoBlockInfo(const GeometryDataBlock* b) {
+void PrintGeoBlockInfo(const GeometryDataBlock* b,
+                       std::ostream& out, std::ostream& err) {
   if (!b) {
-    cerr << "Block cast error" << endl;
+    err << "Block cast error\n";
     return;
   }
 
-  cout << "      Description: " << b->m_Desc.c_str() << ".\n";
+  out << "      Description: " << b->m_Desc.c_str() << ".\n";
   size_t vI = b->GetVertexIndices().size()/3;
   size_t vN = b->GetNormalIndices().size()/3;
   size_t vT = b->GetTexCoordIndices().size()/2;
@@ -286,49 +453,116 @@ void PrintGeoBlockInfo(const GeometryDataBlock* b) {
   size_t t = b->GetTexCoords().size()/size_t(b->GetPolySize());
   size_t c = b->GetColors().size()/size_t(b->GetPolySize());
 
-  cout << "      Polygon count: " << vI << ".\n";
-  if (vI == vN) cout << "      Valid Normals found.\n";
-  if (vI == vT) cout << "      Valid Texture Coordinates found.\n";
-  if (vI == vC) cout << "      Valid Colors found.\n";
+  out << "      Polygon count: " << vI << ".\n";
+  if (vI == vN) out << "      Valid Normals found.\n";
+  if (vI == vT) out << "      Valid Texture Coordinates found.\n";
+  if (vI == vC) out << "      Valid Colors found.\n";
 
-  cout << "      Vertex count: " << v << ".\n";
-  if (n > 0) cout << "      Normal count: " << n << ".\n";
-  if (t > 0) cout << "      Texture Coordinate count: " << t << ".\n";
-  if (c > 0) cout << "      Color count: " << c << ".\n";
+  out << "      Vertex count: " << v << ".\n";
+  if (n > 0) out << "      Normal count: " << n << ".\n";
+  if (t > 0) out << "      Texture Coordinate count: " << t << ".\n";
+  if (c > 0) out << "      Color count: " << c << ".\n";
 
   const std::vector< float >&  col = b->GetDefaultColor();
-  cout << "      Default Color: " << col[0] << " "
+  out << "      Default Color: " << col[0] << " "
         << col[1] << " " << col[2] << " " << col[3];
   if (c > 0)
-    cout << " (not used since vertex colors are specified)\n";
+    out << " (not used since vertex colors are specified)\n";
   else
-    cout << "\n";
+    out << "\n";
+}
+
+// Results of the checks run by OpenUVF, the statistics are only set for
+// the tests that actually ran.
+struct VerificationResult {
+  bool                     bChecksumStreamed;
+  ChecksumStats            checksum;
+  bool                     bBricksVerified;
+  ChecksumStats            bricks;
+  std::vector<std::string> vDamagedBricks;
+};
+
+// Opens an UVF file and runs the requested tests. MD5 checksums are checked
+// with the streaming verifier, UVF::Open only needs to check the other
+// checksum types. Brick checksums are tested on iWorkers threads (0 is one
+// per core). On failure the file is closed again.
+bool OpenUVF(UVF& uvfFile, const std::string& strUVFName, bool bVerify,
+             bool bVerifyBricks, VerificationResult& result,
+             std::string& strProblem, unsigned int iWorkers = 0) {
+  result.bChecksumStreamed = false;
+  result.bBricksVerified = false;
+  result.vDamagedBricks.clear();
+
+  bool bOpened = uvfFile.Open(false, false, false, &strProblem);
+  if (!bOpened) return false;
+
+  const UVFTables::ChecksumSemantic eChecksum =
+    uvfFile.GetGlobalHeader().ulChecksumSemanticsEntry;
+  if (bVerify && eChecksum == UVFTables::CS_MD5) {
+    if (!VerifyUVFChecksum(strUVFName, uvfFile.GetGlobalHeader(),
+                           result.checksum, strProblem)) {
+      uvfFile.Close();
+      return false;
+    }
+    result.bChecksumStreamed = true;
+  } else if (bVerify) {
+    uvfFile.Close();
+    if (!uvfFile.Open(false, true, false, &strProblem)) return false;
+  }
+
+  if (bVerifyBricks) {
+    if (!VerifyBrickChecksums(strUVFName, WorkerCount(iWorkers),
+                              result.vDamagedBricks, result.bricks,
+                              strProblem)) {
+      uvfFile.Close();
+      return false;
+    }
+    result.bBricksVerified = true;
+    if (!result.vDamagedBricks.empty()) {
+      strProblem = SysTools::ToString(result.vDamagedBricks.size()) +
+                   " damaged brick(s)";
+      uvfFile.Close();
+      return false;
+    }
+  }
+  return true;
 }
 
 bool DisplayUVFInfo(std::string strUVFName, bool bVerify, bool bShowData, 
-                    bool bShow1dhist, bool bShow2dhist) {
+                    bool bShow1dhist, bool bShow2dhist,
+                    bool bVerifyBricks = false, bool bScanBricks = false,
+                    std::ostream& out = std::cout,
+                    std::ostream& err = std::cerr,
+                    unsigned int iWorkers = 0) {
   wstring wstrUVFName(strUVFName.begin(), strUVFName.end());
   UVF uvfFile(wstrUVFName);
   std::string strProblem;
-  if (!uvfFile.Open(false, bVerify, false, &strProblem)) {
-    cerr << endl << "Unable to open file " << strUVFName.c_str() << "!"
-          << endl << "Error: " << strProblem.c_str() << endl;
+  VerificationResult verification;
+  if (!OpenUVF(uvfFile, strUVFName, bVerify, bVerifyBricks, verification,
+               strProblem, iWorkers)) {
+    err << "\n" << "Unable to open file " << strUVFName.c_str() << "!"
+          << "\n" << "Error: " << strProblem.c_str() << "\n";
+    if (!verification.vDamagedBricks.empty()) {
+      err << "  Damaged bricks (LoD x y z):\n";
+      for (size_t i = 0;i<verification.vDamagedBricks.size();i++)
+        err << "    " << verification.vDamagedBricks[i] << "\n";
+    }
     return false;
   }
 
-  cout << "Successfully opened UVF File " << strUVFName.c_str() << endl;
+  out << "Successfully opened UVF File " << strUVFName.c_str() << "\n";
   const GlobalHeader& gh = uvfFile.GetGlobalHeader();
 
   if (gh.bIsBigEndian) {
-    cout << "  File is BIG endian format!" << endl;
+    out << "  File is BIG endian format!\n";
   } else {
-    cout << "  File is little endian format!" << endl;
+    out << "  File is little endian format!\n";
   }
 
-  cout << "  The version of the file is "
+  out << "  The version of the file is "
         << gh.ulFileVersion
         << " (the version of the reader is " << UVF::ms_ulReaderVersion
-        << ")"<< endl
+        << ")"<< "\n"
         << "  The file uses the "
         << UVFTables::ChecksumSemanticToCharString(
                                 gh.ulChecksumSemanticsEntry).c_str()
@@ -337,69 +571,444 @@ bool DisplayUVFInfo(std::string strUVFName, bool bVerify, bool bShowData,
   if (gh.ulChecksumSemanticsEntry > UVFTables::CS_NONE &&
       gh.ulChecksumSemanticsEntry < UVFTables::CS_UNKNOWN)
   {
-    if (bVerify) {
+    if (!bVerify) {
+      out << "  [Checksum not verified by parameter!]\n";
+    } else if (verification.bChecksumStreamed) {
+      const ChecksumStats& stats = verification.checksum;
+      out << "  [Checksum is valid!] (" << stats.iBytes/(1024*1024)
+          << " MB in " << stats.fSeconds << " s, " << stats.Throughput()
+          << " MB/s)\n";
+    } else {
       // since we opened the file with verify, the checksum must be valid
       // if we are at this point :-)
-      cout << "  [Checksum is valid!]" << endl;
-    } else {
-      cout << "  [Checksum not verified by parameter!]" << endl;
+      out << "  [Checksum is valid!]\n";
     }
   } else {
-    cout << endl;
+    out << "\n";
+  }
+
+  if (verification.bBricksVerified) {
+    const ChecksumStats& stats = verification.bricks;
+    out << "  [All brick checksums are valid!] (" << stats.iBytes/(1024*1024)
+        << " MB in " << stats.fSeconds << " s, " << stats.Throughput()
+        << " MB/s)\n";
   }
 
   if (gh.ulAdditionalHeaderSize > 0) {
-    cout << "  further (unparsed) global header information was found!!! "
-          << endl;
+    out << "  further (unparsed) global header information was found!!! "
+          << "\n";
   }
   if (uvfFile.GetDataBlockCount() ==  1) {
-    cout << "  It contains one block of data" << endl;
+    out << "  It contains one block of data\n";
   } else {
-    cout << "  It contains " << uvfFile.GetDataBlockCount()
-          << " blocks of data" << endl;
+    out << "  It contains " << uvfFile.GetDataBlockCount()
+          << " blocks of data\n";
   }
 
+  // the brick scan covers the first TOC block only
+  std::vector<BrickContent> vContent;
+  if (bScanBricks &&
+      !ScanBrickContents(strUVFName, WorkerCount(iWorkers), vContent,
+                         strProblem))
+    err << "  Brick scan failed: " << strProblem.c_str() << "\n";
+
   for(uint64_t i = 0; i<uvfFile.GetDataBlockCount(); i++) {
     const DataBlock* b = uvfFile.GetDataBlock(i).get();
-    PrintGeneralBlockInfo(b, i);
+    PrintGeneralBlockInfo(b, i, out);
     switch (b->GetBlockSemantic()) {
       case UVFTables::BS_TOC_BLOCK:
-        PrintToCBlockInfo(dynamic_cast<const TOCBlock*>(b));
+        PrintToCBlockInfo(dynamic_cast<const TOCBlock*>(b), vContent,
+                          out, err);
+        vContent.clear();
+        if (bShowData) {
+          out << "        raw data:\n";
+          const DumpRegion all = {UINT64VECTOR3(0, 0, 0),
+                                  UINT64VECTOR3(0, 0, 0)};
+          if (!DumpTOCBlock(dynamic_cast<const TOCBlock*>(b), 0, all,
+                            DF_TEXT, out, strProblem))
+            err << "Unable to display the data: " << strProblem << "\n";
+        }
         break;
       case UVFTables::BS_REG_NDIM_GRID :
         PrintRDBlockInfo(dynamic_cast<const RasterDataBlock*>(b),
-                          bShowData);
+                          bShowData, TemporaryFileName(strUVFName, "flat.tmp"),
+                          out, err);
         break;
       case UVFTables::BS_KEY_VALUE_PAIRS :
-        PrintKVPBlockInfo(dynamic_cast<const KeyValuePairDataBlock*>(b));
+        PrintKVPBlockInfo(dynamic_cast<const KeyValuePairDataBlock*>(b), out, err);
         break;
       case UVFTables::BS_1D_HISTOGRAM:
         PrintH1DBlockInfo(dynamic_cast<const Histogram1DDataBlock*>(b),
-                            bShow1dhist);
+                            bShow1dhist, out, err);
         break;
       case UVFTables::BS_2D_HISTOGRAM:
         PrintH2DBlockInfo(dynamic_cast<const Histogram2DDataBlock*>(b),
-                            bShow2dhist);
+                            bShow2dhist, out, err);
         break;
       case UVFTables::BS_MAXMIN_VALUES:
-        PrintMaxMinBlockInfo(dynamic_cast<const MaxMinDataBlock*>(b));
+        PrintMaxMinBlockInfo(dynamic_cast<const MaxMinDataBlock*>(b), out, err);
         break;
       case UVFTables::BS_GEOMETRY:
-        PrintGeoBlockInfo(dynamic_cast<const GeometryDataBlock*>(b));
+        PrintGeoBlockInfo(dynamic_cast<const GeometryDataBlock*>(b), out, err);
         break;
       default:
         /// \todo handle other block types
-        T_ERROR("    -->  Unknown/Unimplemented block type %d",
-                static_cast<int>(b->GetBlockSemantic()));
+        err << "    -->  Unknown/Unimplemented block type "
+            << static_cast<int>(b->GetBlockSemantic()) << "\n";
         break;
     }
   }
 
   uvfFile.Close();
+  out.flush();
 
   return true;
 }
 
+void ReportDistribution(const std::string& strName, const Distribution& d,
+                        ReportWriter& r) {
+  r.BeginObject(strName);
+  r.Value("count", d.iCount);
+  r.Value("min", d.fMin);
+  r.Value("median", d.fMedian);
+  r.Value("p99", d.fP99);
+  r.Value("max", d.fMax);
+  r.EndObject();
+}
+
+void ReportToCBlock(const TOCBlock* b,
+                    const std::vector<BrickContent>& vContent,
+                    ReportWriter& r) {
+  r.Value("lod_count", b->GetLoDCount());
+  r.Vector3("max_brick_size", b->GetMaxBrickSize());
+  r.Value("overlap", b->GetOverlap());
+  r.Value("component_type_size", b->GetComponentTypeSize());
+  r.Value("component_count", b->GetComponentCount());
+
+  uint64_t iStored = 0;
+  uint64_t iUncompressed = 0;
+  const std::vector<LODSummary> vSummary = SummarizeTOC(b);
+  r.BeginArray("lods");
+  for (uint64_t i=0;i<b->GetLoDCount();++i) {
+    const LODSummary& s = vSummary[size_t(i)];
+    iStored += s.iCompressedBytes;
+    iUncompressed += s.iUncompressedBytes;
+
+    r.BeginObject();
+    r.Value("level", i);
+    r.Vector3("size", s.vDomainSize);
+    r.Vector3("bricks", s.vBrickCount);
+    r.Value("brick_count", s.vBrickCount.volume());
+    r.Value("stored_bytes", s.iCompressedBytes);
+    r.Value("uncompressed_bytes", s.iUncompressedBytes);
+    r.Value("compression_ratio", s.CompressionRatio());
+    r.BeginObject("codecs");
+    for (size_t c = 0;c<LODSummary::CODEC_COUNT;c++)
+      if (s.iCodecBricks[c]) r.Value(CodecName(c), s.iCodecBricks[c]);
+    r.EndObject();
+    ReportDistribution("stored_bytes_per_brick", s.storedBytes, r);
+    ReportDistribution("compression_ratio_per_brick", s.ratio, r);
+    ReportDistribution("offset_gap", s.offsetGap, r);
+    if (i < vContent.size()) {
+      r.Value("empty_bricks", vContent[size_t(i)].iEmpty);
+      r.Value("constant_bricks", vContent[size_t(i)].iConstant);
+    }
+    r.EndObject();
+  }
+  r.EndArray();
+
+  r.Value("stored_bytes", iStored);
+  r.Value("uncompressed_bytes", iUncompressed);
+  r.Value("compression_ratio",
+          iStored > 0 ? double(iUncompressed)/double(iStored) : 0.0);
+}
+
+void ReportRDBlock(const RasterDataBlock* b, ReportWriter& r) {
+  r.BeginArray("semantics");
+  for (size_t j=0; j < b->ulDomainSemantics.size(); j++)
+    r.Value("", DomainSemanticToCharString(b->ulDomainSemantics[j]));
+  r.EndArray();
+  r.Value("lod_count", b->ulLODDecFactor.size());
+  r.BeginArray("size");
+  for (size_t j = 0;j<b->ulDomainSize.size();j++)
+    r.Value("", b->ulDomainSize[j]);
+  r.EndArray();
+
+  r.BeginArray("elements");
+  for (size_t j = 0;j<b->ulElementDimension;j++) {
+    for (size_t k = 0;k<b->ulElementDimensionSize[j];k++) {
+      r.BeginObject();
+      r.Value("semantic", UVFTables::ElementSemanticTableToCharString(
+                            b->ulElementSemantic[j][k]));
+      r.Value("bits", b->ulElementBitSize[j][k]);
+      r.Value("mantissa", b->ulElementMantissa[j][k]);
+      r.Value("signed", bool(b->bSignedElement[j][k]));
+      r.EndObject();
+    }
+  }
+  r.EndArray();
+
+  r.BeginArray("transformation");
+  for (size_t j = 0;j<b->dDomainTransformation.size();j++)
+    r.Value("", b->dDomainTransformation[j]);
+  r.EndArray();
+}
+
+void ReportKVPBlock(const KeyValuePairDataBlock* b, ReportWriter& r) {
+  r.Value("data_size", b->ComputeDataSize());
+  r.BeginObject("values");
+  for (size_t i = 0;i<b->GetKeyCount();i++)
+    r.Value(b->GetKeyByIndex(i), b->GetValueByIndex(i));
+  r.EndObject();
+}
+
+void ReportH1DBlock(const Histogram1DDataBlock* b, bool bShow1dhist,
+                    ReportWriter& r) {
+  const size_t iFilledSize = FilledSize(b);
+  r.Value("bins", b->GetHistogram().size());
+  r.Value("filled_size", iFilledSize);
+  if (bShow1dhist) {
+    r.BeginArray("entries");
+    for (size_t i = 0;i<iFilledSize;i++)
+      r.Value("", b->GetHistogram()[i]);
+    r.EndArray();
+  }
+}
+
+void ReportH2DBlock(const Histogram2DDataBlock* b, bool bShow2dhist,
+                    ReportWriter& r) {
+  const VECTOR2<size_t> vSize = FilledSize(b);
+  r.BeginArray("filled_size");
+  r.Value("", vSize.x);
+  r.Value("", vSize.y);
+  r.EndArray();
+  r.Value("max_gradient", b->GetMaxGradMagnitude());
+  if (bShow2dhist) {
+    // one row per value bin, each holding the gradient bins
+    r.BeginArray("entries");
+    for (size_t i = 0; i < vSize.x; i++) {
+      r.BeginArray();
+      for (size_t j = 0; j < vSize.y; j++)
+        r.Value("", b->GetHistogram()[i][j]);
+      r.EndArray();
+    }
+    r.EndArray();
+  }
+}
+
+void ReportMaxMinBlock(const MaxMinDataBlock* b, ReportWriter& r) {
+  r.BeginArray("components");
+  for (size_t i = 0;i<b->GetComponentCount();++i) {
+    r.BeginObject();
+    r.Value("min", b->GetGlobalValue(i).minScalar);
+    r.Value("max", b->GetGlobalValue(i).maxScalar);
+    r.Value("min_gradient", b->GetGlobalValue(i).minGradient);
+    r.Value("max_gradient", b->GetGlobalValue(i).maxGradient);
+    r.EndObject();
+  }
+  r.EndArray();
+}
+
+void ReportGeoBlock(const GeometryDataBlock* b, ReportWriter& r) {
+  const size_t iPolySize = size_t(b->GetPolySize());
+  r.Value("description", b->m_Desc);
+  r.Value("polygon_count", b->GetVertexIndices().size()/3);
+  r.Value("vertex_count", b->GetVertices().size()/iPolySize);
+  r.Value("normal_count", b->GetNormals().size()/iPolySize);
+  r.Value("texcoord_count", b->GetTexCoords().size()/iPolySize);
+  r.Value("color_count", b->GetColors().size()/iPolySize);
+  r.BeginArray("default_color");
+  for (size_t i = 0;i<b->GetDefaultColor().size();i++)
+    r.Value("", b->GetDefaultColor()[i]);
+  r.EndArray();
+}
+
+// Structured (JSON or CSV) counterpart of DisplayUVFInfo, writes one record
+// per file. Files that fail to open or verify still get a record, with
+// "status" set to "failed" and the reason in "error".
+bool ReportUVFInfo(const std::string& strUVFName, bool bVerify,
+                   bool bShow1dhist, bool bShow2dhist, bool bVerifyBricks,
+                   bool bScanBricks, ReportWriter& r,
+                   unsigned int iWorkers = 0) {
+  wstring wstrUVFName(strUVFName.begin(), strUVFName.end());
+  UVF uvfFile(wstrUVFName);
+  std::string strProblem;
+  VerificationResult verification;
+  const bool bOpened = OpenUVF(uvfFile, strUVFName, bVerify, bVerifyBricks,
+                               verification, strProblem, iWorkers);
+
+  r.BeginObject(strUVFName);
+  r.Value("file", strUVFName);
+  r.Value("status", bOpened ? "ok" : "failed");
+  if (!bOpened) {
+    r.Value("error", strProblem);
+    if (!verification.vDamagedBricks.empty()) {
+      r.BeginArray("damaged_bricks");
+      for (size_t i = 0;i<verification.vDamagedBricks.size();i++)
+        r.Value("", verification.vDamagedBricks[i]);
+      r.EndArray();
+    }
+    r.EndObject();
+    return false;
+  }
+
+  const GlobalHeader& gh = uvfFile.GetGlobalHeader();
+  r.Value("endianness", gh.bIsBigEndian ? "big" : "little");
+  r.Value("version", gh.ulFileVersion);
+  r.Value("reader_version", UVF::ms_ulReaderVersion);
+  r.Value("additional_header_bytes", gh.ulAdditionalHeaderSize);
+
+  r.BeginObject("checksum");
+  r.Value("type", UVFTables::ChecksumSemanticToCharString(
+                    gh.ulChecksumSemanticsEntry));
+  r.Value("bits", gh.vcChecksum.size()*8);
+  r.Value("verified", bVerify &&
+                      gh.ulChecksumSemanticsEntry > UVFTables::CS_NONE &&
+                      gh.ulChecksumSemanticsEntry < UVFTables::CS_UNKNOWN);
+  if (verification.bChecksumStreamed) {
+    r.Value("bytes", verification.checksum.iBytes);
+    r.Value("seconds", verification.checksum.fSeconds);
+    r.Value("mb_per_second", verification.checksum.Throughput());
+  }
+  r.EndObject();
+
+  if (verification.bBricksVerified) {
+    r.BeginObject("brick_checksums");
+    r.Value("verified", true);
+    r.Value("bytes", verification.bricks.iBytes);
+    r.Value("seconds", verification.bricks.fSeconds);
+    r.Value("mb_per_second", verification.bricks.Throughput());
+    r.EndObject();
+  }
+
+  std::vector<BrickContent> vContent;
+  if (bScanBricks &&
+      !ScanBrickContents(strUVFName, WorkerCount(iWorkers), vContent,
+                         strProblem))
+    r.Value("brick_scan_error", strProblem);
+
+  r.BeginArray("blocks");
+  for(uint64_t i = 0; i<uvfFile.GetDataBlockCount(); i++) {
+    const DataBlock* b = uvfFile.GetDataBlock(i).get();
+    r.BeginObject();
+    r.Value("index", i);
+    r.Value("id", b->strBlockID);
+    r.Value("type",
+            UVFTables::BlockSemanticTableToCharString(b->GetBlockSemantic()));
+    r.Value("compression",
+            UVFTables::CompressionSemanticToCharString(b->ulCompressionScheme));
+
+    switch (b->GetBlockSemantic()) {
+      case UVFTables::BS_TOC_BLOCK:
+        ReportToCBlock(dynamic_cast<const TOCBlock*>(b), vContent, r);
+        vContent.clear();
+        break;
+      case UVFTables::BS_REG_NDIM_GRID :
+        ReportRDBlock(dynamic_cast<const RasterDataBlock*>(b), r);
+        break;
+      case UVFTables::BS_KEY_VALUE_PAIRS :
+        ReportKVPBlock(dynamic_cast<const KeyValuePairDataBlock*>(b), r);
+        break;
+      case UVFTables::BS_1D_HISTOGRAM:
+        ReportH1DBlock(dynamic_cast<const Histogram1DDataBlock*>(b),
+                       bShow1dhist, r);
+        break;
+      case UVFTables::BS_2D_HISTOGRAM:
+        ReportH2DBlock(dynamic_cast<const Histogram2DDataBlock*>(b),
+                       bShow2dhist, r);
+        break;
+      case UVFTables::BS_MAXMIN_VALUES:
+        ReportMaxMinBlock(dynamic_cast<const MaxMinDataBlock*>(b), r);
+        break;
+      case UVFTables::BS_GEOMETRY:
+        ReportGeoBlock(dynamic_cast<const GeometryDataBlock*>(b), r);
+        break;
+      default:
+        break;
+    }
+    r.EndObject();
+  }
+  r.EndArray();
+  r.EndObject();
+
+  uvfFile.Close();
+  return true;
+}
+
+// Inspects (and verifies) a list of files on iWorkers threads, each with
+// its own UVF instance. The report of every file is buffered and printed
+// in input order as soon as the file and all files before it are done, so
+// the output looks the same for any worker count. Structured reports are
+// combined into one JSON array or one CSV table. The threads of the brick
+// tests and scans are split between the files in flight, so the total
+// stays at iWorkers. Data dumps are too large to buffer, with bShowData
+// the files are processed one after the other and printed directly.
+// Returns the names of the files that could not be opened or failed the
+// checksum test.
+std::vector<std::string> DisplayUVFInfo(const std::vector<std::string>& vFiles,
+                                        unsigned int iWorkers, bool bVerify,
+                                        bool bShowData, bool bShow1dhist,
+                                        bool bShow2dhist,
+                                        bool bVerifyBricks, bool bScanBricks,
+                                        EReportFormat eFormat = RF_TEXT) {
+  std::vector<char> vSuccess(vFiles.size(), 0);
+  std::vector<std::string> vFailed;
+
+  if (bShowData && eFormat == RF_TEXT) {
+    for (size_t i = 0;i<vFiles.size();i++) {
+      if (!DisplayUVFInfo(vFiles[i], bVerify, bShowData, bShow1dhist,
+                          bShow2dhist, bVerifyBricks, bScanBricks, cout,
+                          cout, iWorkers))
+        vFailed.push_back(vFiles[i]);
+      cout << "\n";
+    }
+    cout.flush();
+    return vFailed;
+  }
+
+  iWorkers = std::max(1u, iWorkers);
+  const unsigned int iFileWorkers =
+    unsigned(std::min<size_t>(iWorkers, vFiles.size()));
+  const unsigned int iBrickWorkers = std::max(1u, iWorkers / iFileWorkers);
+
+  if (eFormat == RF_JSON) cout << "[\n";
+  if (eFormat == RF_CSV) cout << ReportWriter::CSVHeader();
+
+  ProduceOrdered(vFiles.size(), iFileWorkers, 4*size_t(iFileWorkers),
+    [&](uint64_t i, std::vector<uint8_t>& report) {
+      std::ostringstream out;
+      if (eFormat == RF_TEXT) {
+        vSuccess[size_t(i)] = DisplayUVFInfo(vFiles[size_t(i)], bVerify,
+                                             bShowData, bShow1dhist,
+                                             bShow2dhist, bVerifyBricks,
+                                             bScanBricks, out, out,
+                                             iBrickWorkers);
+      } else {
+        ReportWriter r(out, eFormat);
+        vSuccess[size_t(i)] = ReportUVFInfo(vFiles[size_t(i)], bVerify,
+                                            bShow1dhist, bShow2dhist,
+                                            bVerifyBricks, bScanBricks, r,
+                                            iBrickWorkers);
+      }
+      const std::string str = out.str();
+      report.assign(str.begin(), str.end());
+    },
+    [&](uint64_t i, const std::vector<uint8_t>& report) {
+      if (eFormat == RF_JSON && i > 0) cout << ",\n";
+      cout.write(reinterpret_cast<const char*>(report.data()),
+                 std::streamsize(report.size()));
+      if (eFormat == RF_TEXT) cout << "\n";
+      return true;
+    });
+
+  if (eFormat == RF_JSON) cout << "]\n";
+  cout.flush();
+
+  for (size_t i = 0;i<vFiles.size();i++)
+    if (!vSuccess[i]) vFailed.push_back(vFiles[i]);
+  return vFailed;
+}
+
 
 #endif // BLOCKINFO_H
 
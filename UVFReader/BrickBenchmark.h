@@ -0,0 +1,365 @@
+#ifndef BRICKBENCHMARK_H
+#define BRICKBENCHMARK_H
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <algorithm>
+#include <random>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <cstdint>
+
+#include "../Tuvok/StdTuvokDefines.h"
+
+#ifdef DETECTED_OS_WINDOWS
+  #ifndef NOMINMAX
+    #define NOMINMAX
+  #endif
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
+
+#include "../Tuvok/Basics/Timer.h"
+#include "../Tuvok/Basics/LargeRAWFile.h"
+#include "../Tuvok/IO/UVF/UVF.h"
+#include "../Tuvok/IO/UVF/TOCBlock.h"
+
+#include "BrickTools.h"
+#include "BlockInfo.h"
+#include "UVFReport.h"
+#include "UVFHeaders.h"
+
+// Evicts the file from the operating system's page cache so the next read
+// has to go to the disk. Returns false if that is not supported here.
+bool DropFileCache(const std::string& strFile) {
+#if defined(DETECTED_OS_WINDOWS)
+  // opening a file unbuffered discards its cached pages
+  HANDLE h = CreateFileA(strFile.c_str(), GENERIC_READ,
+                         FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+                         OPEN_EXISTING, FILE_FLAG_NO_BUFFERING, NULL);
+  if (h == INVALID_HANDLE_VALUE) return false;
+  CloseHandle(h);
+  return true;
+#elif defined(DETECTED_OS_LINUX)
+  const int fd = open(strFile.c_str(), O_RDONLY);
+  if (fd < 0) return false;
+  const bool bDropped = posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+  close(fd);
+  return bDropped;
+#else
+  return false;
+#endif
+}
+
+// Bricks, bytes and the summed per brick times of one codec: reading the
+// stored bytes from the file and decompressing them.
+struct CodecTiming {
+  uint64_t iBricks;
+  uint64_t iStoredBytes;
+  uint64_t iDecodedBytes;
+  double   fReadSeconds;
+  double   fDecodeSeconds;
+};
+
+struct BenchmarkRun {
+  bool     bCold;       // the page cache was dropped before the run
+  double   fSeconds;    // wall clock time of all workers
+  uint64_t iStoredBytes;
+  uint64_t iDecodedBytes;
+  std::vector<CodecTiming> vCodecs;  // indexed by CodecIndex
+};
+
+struct BenchmarkResult {
+  uint64_t     iLoD;
+  uint64_t     iBrickCount;   // bricks of the LoD
+  uint64_t     iSampleCount;  // bricks loaded per run
+  unsigned int iThreads;
+  std::vector<BenchmarkRun> vRuns;
+};
+
+double MBPerSecond(uint64_t iBytes, double fSeconds) {
+  return fSeconds > 0 ? double(iBytes)/(1024.0*1024.0)/fSeconds : 0.0;
+}
+
+// Offset of the brick data of the first TOC block in the file, the TOC
+// entries count from there. The octree follows the block header directly;
+// every entry of vBricks is checked to lie inside the block.
+bool FindBrickDataOffset(const std::string& strUVFName, const TOCBlock* toc,
+                         const std::vector<UINT64VECTOR4>& vBricks,
+                         uint64_t& iDataOffset, std::string& strProblem) {
+  UVFHeaderListing listing;
+  if (!ReadUVFHeaders(strUVFName, listing, strProblem)) return false;
+  for (size_t i = 0;i<listing.vBlocks.size();i++) {
+    const UVFBlockHeader& h = listing.vBlocks[i];
+    if (h.eSemantic != UVFTables::BS_TOC_BLOCK) continue;
+    for (size_t b = 0;b<vBricks.size();b++) {
+      const TOCEntry& te = toc->GetBrickInfo(vBricks[b]);
+      if (te.m_iOffset + te.m_iLength > h.iPayloadSize) {
+        strProblem = "brick " + BrickKeyToString(vBricks[b]) +
+                     " lies outside of the TOC block";
+        return false;
+      }
+    }
+    iDataOffset = h.iOffset + h.iHeaderSize;
+    return true;
+  }
+  strProblem = "file has no TOC block";
+  return false;
+}
+
+// Loads the given bricks once on iThreads workers. Every brick is loaded in
+// two timed steps: its stored bytes are read from the file at the TOC
+// entry, then the TOC block loads the brick, which now finds these bytes
+// in the page cache and spends its time decompressing. Every worker opens
+// the file first, the clock only starts once all of them are ready.
+bool TimeBrickLoads(const std::string& strUVFName, uint64_t iDataOffset,
+                    const std::vector<UINT64VECTOR4>& vBricks,
+                    unsigned int iThreads, BenchmarkRun& run,
+                    std::string& strProblem) {
+  const std::wstring wstrUVFName(strUVFName.begin(), strUVFName.end());
+  iThreads = std::max(1u, iThreads);
+
+  std::mutex m;
+  std::condition_variable cvReady;
+  unsigned int iReady = 0;
+  bool bFailed = false;
+  std::atomic<uint64_t> iNext(0);
+  Timer wallTimer;
+
+  run.fSeconds = 0.0;
+  run.iStoredBytes = 0;
+  run.iDecodedBytes = 0;
+  CodecTiming none = {0, 0, 0, 0.0, 0.0};
+  run.vCodecs.assign(LODSummary::CODEC_COUNT, none);
+
+  std::vector<std::thread> threads;
+  for (unsigned int t = 0;t<iThreads;t++) {
+    threads.push_back(std::thread([&]() {
+      UVF uvfFile(wstrUVFName);
+      const TOCBlock* toc = uvfFile.Open(false, false, false)
+                            ? FindTOCBlock(uvfFile) : NULL;
+      LargeRAWFile raw(strUVFName);
+      const bool bRawOpen = raw.Open(false);
+      {
+        std::unique_lock<std::mutex> lock(m);
+        if (!toc || !bRawOpen) bFailed = true;
+        if (++iReady == iThreads) {
+          wallTimer.Start();
+          cvReady.notify_all();
+        } else {
+          cvReady.wait(lock, [&]() { return iReady == iThreads; });
+        }
+        if (bFailed) {
+          if (toc) uvfFile.Close();
+          if (bRawOpen) raw.Close();
+          return;
+        }
+      }
+
+      std::vector<CodecTiming> vLocal(LODSummary::CODEC_COUNT, none);
+      std::vector<uint8_t> stored;
+      std::vector<uint8_t> data;
+      bool bShortRead = false;
+      for (uint64_t i = iNext++;i<vBricks.size() && !bShortRead;
+           i = iNext++) {
+        const UINT64VECTOR4& key = vBricks[size_t(i)];
+        const TOCEntry& te = toc->GetBrickInfo(key);
+        stored.resize(size_t(te.m_iLength));
+        data.resize(BrickBytes(toc, key));
+
+        Timer readTimer;
+        readTimer.Start();
+        raw.SeekPos(iDataOffset + te.m_iOffset);
+        bShortRead = raw.ReadRAW(stored.data(), te.m_iLength) !=
+                     te.m_iLength;
+        const double fReadSeconds = readTimer.Elapsed()/1000.0;
+
+        Timer decodeTimer;
+        decodeTimer.Start();
+        toc->GetData(data.data(), key);
+        const double fDecodeSeconds = decodeTimer.Elapsed()/1000.0;
+
+        CodecTiming& c = vLocal[CodecIndex(te.m_eCompression)];
+        c.iBricks++;
+        c.iStoredBytes += te.m_iLength;
+        c.iDecodedBytes += data.size();
+        c.fReadSeconds += fReadSeconds;
+        c.fDecodeSeconds += fDecodeSeconds;
+      }
+      raw.Close();
+      uvfFile.Close();
+
+      std::lock_guard<std::mutex> lock(m);
+      if (bShortRead) bFailed = true;
+      for (size_t c = 0;c<vLocal.size();c++) {
+        run.vCodecs[c].iBricks        += vLocal[c].iBricks;
+        run.vCodecs[c].iStoredBytes   += vLocal[c].iStoredBytes;
+        run.vCodecs[c].iDecodedBytes  += vLocal[c].iDecodedBytes;
+        run.vCodecs[c].fReadSeconds   += vLocal[c].fReadSeconds;
+        run.vCodecs[c].fDecodeSeconds += vLocal[c].fDecodeSeconds;
+        run.iStoredBytes  += vLocal[c].iStoredBytes;
+        run.iDecodedBytes += vLocal[c].iDecodedBytes;
+      }
+    }));
+  }
+  for (size_t t = 0;t<threads.size();t++) threads[t].join();
+  run.fSeconds = wallTimer.Elapsed()/1000.0;
+
+  if (bFailed) {
+    strProblem = "unable to read the bricks of " + strUVFName;
+    return false;
+  }
+  return true;
+}
+
+// Loads all bricks of one LoD (or a random sample of iSample of them, 0 for
+// all) with iThreads workers, first with a cold and then with a warm page
+// cache. Bricks are requested in scanline order of their keys, so the
+// brick layout of the file shows in the cold numbers.
+bool BenchmarkBricks(const std::string& strUVFName, uint64_t iLoD,
+                     uint64_t iSample, uint64_t iSeed, unsigned int iThreads,
+                     BenchmarkResult& result, std::string& strProblem) {
+  std::vector<UINT64VECTOR4> vBricks;
+  uint64_t iDataOffset = 0;
+  {
+    const std::wstring wstrUVFName(strUVFName.begin(), strUVFName.end());
+    UVF uvfFile(wstrUVFName);
+    if (!uvfFile.Open(false, false, false, &strProblem)) return false;
+    const TOCBlock* toc = FindTOCBlock(uvfFile);
+    if (!toc || iLoD >= toc->GetLoDCount()) {
+      strProblem = toc ? "level of detail out of range"
+                       : "file has no TOC block";
+      uvfFile.Close();
+      return false;
+    }
+    vBricks = LoDBricks(toc, iLoD);
+    const bool bFound = FindBrickDataOffset(strUVFName, toc, vBricks,
+                                            iDataOffset, strProblem);
+    uvfFile.Close();
+    if (!bFound) return false;
+  }
+
+  result.iLoD = iLoD;
+  result.iBrickCount = vBricks.size();
+  result.iThreads = std::max(1u, iThreads);
+  result.vRuns.clear();
+
+  if (iSample > 0 && iSample < vBricks.size()) {
+    std::mt19937_64 rng(iSeed);
+    std::shuffle(vBricks.begin(), vBricks.end(), rng);
+    vBricks.resize(size_t(iSample));
+    std::sort(vBricks.begin(), vBricks.end(),
+              [](const UINT64VECTOR4& a, const UINT64VECTOR4& b) {
+                if (a.z != b.z) return a.z < b.z;
+                if (a.y != b.y) return a.y < b.y;
+                return a.x < b.x;
+              });
+  }
+  result.iSampleCount = vBricks.size();
+
+  for (int iRun = 0;iRun<2;iRun++) {
+    BenchmarkRun run;
+    run.bCold = (iRun == 0) && DropFileCache(strUVFName);
+    if (iRun == 0 && !run.bCold)
+      WARNING("Unable to drop the file cache, the first run may be warm");
+    if (!TimeBrickLoads(strUVFName, iDataOffset, vBricks, result.iThreads,
+                        run, strProblem))
+      return false;
+    result.vRuns.push_back(run);
+  }
+  return true;
+}
+
+void PrintBenchmark(const std::string& strUVFName,
+                    const BenchmarkResult& result, std::ostream& out) {
+  out << "Brick benchmark of " << strUVFName << ", LoD " << result.iLoD
+      << ", " << result.iSampleCount << " of " << result.iBrickCount
+      << " bricks, " << result.iThreads << " thread(s)\n";
+  for (size_t r = 0;r<result.vRuns.size();r++) {
+    const BenchmarkRun& run = result.vRuns[r];
+    out << "  " << (run.bCold ? "Cold" : "Warm") << " cache: "
+        << run.iStoredBytes << " bytes stored, " << run.iDecodedBytes
+        << " bytes decoded in " << run.fSeconds << " s\n";
+    for (size_t c = 0;c<run.vCodecs.size();c++) {
+      const CodecTiming& t = run.vCodecs[c];
+      if (t.iBricks == 0) continue;
+      out << "    " << CodecName(c) << ": " << t.iBricks << " bricks, "
+          << MBPerSecond(t.iStoredBytes, t.fReadSeconds) << " MB/s read, "
+          << MBPerSecond(t.iDecodedBytes, t.fDecodeSeconds)
+          << " MB/s decompressed per thread\n";
+    }
+  }
+  out.flush();
+}
+
+void ReportBenchmark(const std::string& strUVFName,
+                     const BenchmarkResult& result, ReportWriter& r) {
+  r.BeginObject(strUVFName);
+  r.Value("file", strUVFName);
+  r.Value("lod", result.iLoD);
+  r.Value("brick_count", result.iBrickCount);
+  r.Value("sample_count", result.iSampleCount);
+  r.Value("threads", result.iThreads);
+  r.BeginArray("runs");
+  for (size_t i = 0;i<result.vRuns.size();i++) {
+    const BenchmarkRun& run = result.vRuns[i];
+    r.BeginObject();
+    r.Value("cache", run.bCold ? "cold" : "warm");
+    r.Value("seconds", run.fSeconds);
+    r.Value("stored_bytes", run.iStoredBytes);
+    r.Value("decoded_bytes", run.iDecodedBytes);
+    r.BeginObject("codecs");
+    for (size_t c = 0;c<run.vCodecs.size();c++) {
+      const CodecTiming& t = run.vCodecs[c];
+      if (t.iBricks == 0) continue;
+      r.BeginObject(CodecName(c));
+      r.Value("bricks", t.iBricks);
+      r.Value("stored_bytes", t.iStoredBytes);
+      r.Value("decoded_bytes", t.iDecodedBytes);
+      r.Value("read_seconds", t.fReadSeconds);
+      r.Value("decompress_seconds", t.fDecodeSeconds);
+      r.Value("read_mb_per_thread_second",
+              MBPerSecond(t.iStoredBytes, t.fReadSeconds));
+      r.Value("decompressed_mb_per_thread_second",
+              MBPerSecond(t.iDecodedBytes, t.fDecodeSeconds));
+      r.EndObject();
+    }
+    r.EndObject();
+    r.EndObject();
+  }
+  r.EndArray();
+  r.EndObject();
+}
+
+#endif // BRICKBENCHMARK_H
+
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2012 Interactive Visualization and Data Analysis Group
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
@@ -0,0 +1,282 @@
+#ifndef BRICKTOOLS_H
+#define BRICKTOOLS_H
+
+#include <string>
+#include <vector>
+#include <sstream>
+#include <atomic>
+#include <thread>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+
+#include "../Tuvok/StdTuvokDefines.h"
+
+#ifdef DETECTED_OS_WINDOWS
+  #include <process.h>
+#else
+  #include <unistd.h>
+#endif
+
+#include "../Tuvok/Basics/SysTools.h"
+#include "../Tuvok/Basics/Vectors.h"
+#include "../Tuvok/IO/UVF/UVF.h"
+#include "../Tuvok/IO/UVF/TOCBlock.h"
+
+#include "ParallelTools.h"
+
+// Brick keys are written as "lod x y z".
+std::string BrickKeyToString(const UINT64VECTOR4& key) {
+  std::ostringstream s;
+  s << key.w << " " << key.x << " " << key.y << " " << key.z;
+  return s.str();
+}
+
+// Name of a scratch file for strUVFName in the system temp directory. The
+// process id and a counter keep concurrent runs and threads apart.
+std::string TemporaryFileName(const std::string& strUVFName,
+                              const std::string& strExt) {
+#ifdef DETECTED_OS_WINDOWS
+  const char* pDir = std::getenv("TEMP");
+  if (!pDir) pDir = std::getenv("TMP");
+  const std::string strDir = pDir ? pDir : ".";
+  const unsigned long iProcess = static_cast<unsigned long>(_getpid());
+#else
+  const char* pDir = std::getenv("TMPDIR");
+  const std::string strDir = pDir ? pDir : "/tmp";
+  const unsigned long iProcess = static_cast<unsigned long>(getpid());
+#endif
+  static std::atomic<unsigned int> iCounter(0);
+  std::ostringstream s;
+  s << strDir << "/" << SysTools::GetFilename(strUVFName) << "."
+    << iProcess << "." << iCounter++ << "." << strExt;
+  return s.str();
+}
+
+// The bricks of one LoD in scanline order.
+std::vector<UINT64VECTOR4> LoDBricks(const TOCBlock* toc, uint64_t iLoD) {
+  std::vector<UINT64VECTOR4> vBricks;
+  const UINT64VECTOR3 count = toc->GetBrickCount(iLoD);
+  for (uint64_t z = 0;z<count.z;z++)
+    for (uint64_t y = 0;y<count.y;y++)
+      for (uint64_t x = 0;x<count.x;x++)
+        vBricks.push_back(UINT64VECTOR4(x, y, z, iLoD));
+  return vBricks;
+}
+
+// All bricks of a TOC block: the LoDBricks of LoD 0, then those of LoD 1
+// and so on, so the bricks of every LoD form one contiguous run.
+std::vector<UINT64VECTOR4> EnumerateBricks(const TOCBlock* toc) {
+  std::vector<UINT64VECTOR4> vBricks;
+  for (uint64_t lod = 0;lod<toc->GetLoDCount();lod++) {
+    const std::vector<UINT64VECTOR4> vLoD = LoDBricks(toc, lod);
+    vBricks.insert(vBricks.end(), vLoD.begin(), vLoD.end());
+  }
+  return vBricks;
+}
+
+// Size of a brick after decompression.
+size_t BrickBytes(const TOCBlock* toc, const UINT64VECTOR4& key) {
+  return size_t(toc->GetBrickSize(key).volume() *
+                toc->GetComponentTypeSize() * toc->GetComponentCount());
+}
+
+// Size of the bricks without their overlap, the spacing of the bricks.
+UINT64VECTOR3 InnerBrickSize(const TOCBlock* toc) {
+  const UINT64VECTOR3 vMaxBrick = toc->GetMaxBrickSize();
+  const uint64_t iOverlap = toc->GetOverlap();
+  return UINT64VECTOR3(vMaxBrick.x - 2 * iOverlap, vMaxBrick.y - 2 * iOverlap,
+                       vMaxBrick.z - 2 * iOverlap);
+}
+
+// Copies the voxels of the brick that lie inside the region (vOffset,
+// vSize) of its LoD into pRegion, which holds the region in scanline
+// order. The overlap of the brick is skipped.
+void CopyBrickIntoRegion(const TOCBlock* toc, const UINT64VECTOR4& key,
+                         const uint8_t* pBrick, const UINT64VECTOR3& vOffset,
+                         const UINT64VECTOR3& vSize, uint8_t* pRegion) {
+  const uint64_t iOverlap = toc->GetOverlap();
+  const UINT64VECTOR3 vInner = InnerBrickSize(toc);
+  const UINT64VECTOR3 vBrickSize = toc->GetBrickSize(key);
+  const size_t iVoxelSize = size_t(toc->GetComponentTypeSize() *
+                                   toc->GetComponentCount());
+  const UINT64VECTOR3 vOrigin(key.x * vInner.x, key.y * vInner.y,
+                              key.z * vInner.z);
+  const UINT64VECTOR3 vBegin(std::max(vOrigin.x, vOffset.x),
+                             std::max(vOrigin.y, vOffset.y),
+                             std::max(vOrigin.z, vOffset.z));
+  const UINT64VECTOR3 vEnd(
+    std::min(vOrigin.x + vBrickSize.x - 2 * iOverlap, vOffset.x + vSize.x),
+    std::min(vOrigin.y + vBrickSize.y - 2 * iOverlap, vOffset.y + vSize.y),
+    std::min(vOrigin.z + vBrickSize.z - 2 * iOverlap, vOffset.z + vSize.z));
+  if (vBegin.x >= vEnd.x || vBegin.y >= vEnd.y || vBegin.z >= vEnd.z)
+    return;
+
+  const size_t iRowBytes = size_t((vEnd.x - vBegin.x) * iVoxelSize);
+  for (uint64_t z = vBegin.z;z<vEnd.z;z++) {
+    for (uint64_t y = vBegin.y;y<vEnd.y;y++) {
+      const uint64_t iSource =
+        (((z - vOrigin.z + iOverlap) * vBrickSize.y +
+          (y - vOrigin.y + iOverlap)) * vBrickSize.x +
+         (vBegin.x - vOrigin.x + iOverlap)) * iVoxelSize;
+      const uint64_t iTarget =
+        (((z - vOffset.z) * vSize.y + (y - vOffset.y)) * vSize.x +
+         (vBegin.x - vOffset.x)) * iVoxelSize;
+      std::copy(pBrick + size_t(iSource),
+                pBrick + size_t(iSource) + iRowBytes,
+                pRegion + size_t(iTarget));
+    }
+  }
+}
+
+// Reads the region (vOffset, vSize) of a LoD from all bricks it touches,
+// vBrick is scratch space for one decompressed brick.
+void ReadTOCRegion(const TOCBlock* toc, uint64_t iLoD,
+                   const UINT64VECTOR3& vOffset, const UINT64VECTOR3& vSize,
+                   std::vector<uint8_t>& vBrick,
+                   std::vector<uint8_t>& vRegion) {
+  const UINT64VECTOR3 vInner = InnerBrickSize(toc);
+  vRegion.resize(size_t(vSize.volume() * toc->GetComponentTypeSize() *
+                        toc->GetComponentCount()));
+  const UINT64VECTOR3 vFirst = vOffset / vInner;
+  const UINT64VECTOR3 vLast((vOffset.x + vSize.x - 1) / vInner.x,
+                            (vOffset.y + vSize.y - 1) / vInner.y,
+                            (vOffset.z + vSize.z - 1) / vInner.z);
+  for (uint64_t z = vFirst.z;z<=vLast.z;z++) {
+    for (uint64_t y = vFirst.y;y<=vLast.y;y++) {
+      for (uint64_t x = vFirst.x;x<=vLast.x;x++) {
+        const UINT64VECTOR4 key(x, y, z, iLoD);
+        vBrick.resize(BrickBytes(toc, key));
+        toc->GetData(vBrick.data(), key);
+        CopyBrickIntoRegion(toc, key, vBrick.data(), vOffset, vSize,
+                            vRegion.data());
+      }
+    }
+  }
+}
+
+const TOCBlock* FindTOCBlock(const UVF& uvfFile) {
+  for (uint64_t i = 0;i<uvfFile.GetDataBlockCount();i++) {
+    const DataBlock* b = uvfFile.GetDataBlock(i).get();
+    if (b->GetBlockSemantic() == UVFTables::BS_TOC_BLOCK)
+      return dynamic_cast<const TOCBlock*>(b);
+  }
+  return NULL;
+}
+
+// Reads the given bricks of the first TOC block on iWorkers threads and
+// calls visit(iWorker, i, toc, data) on the worker for the i-th brick.
+// Reading from a TOC block is not thread safe, so every worker opens the
+// file itself; the visitor must synchronize access to shared results.
+template<typename Visitor>
+bool ForEachBrick(const std::string& strUVFName,
+                  const std::vector<UINT64VECTOR4>& vBricks,
+                  unsigned int iWorkers, Visitor visit,
+                  std::string& strProblem) {
+  const std::wstring wstrUVFName(strUVFName.begin(), strUVFName.end());
+  if (vBricks.size() < iWorkers) iWorkers = unsigned(vBricks.size());
+  iWorkers = std::max(1u, iWorkers);
+
+  std::atomic<uint64_t> iNext(0);
+  std::atomic<bool> bOpenFailed(false);
+
+  std::vector<std::thread> threads;
+  for (unsigned int t = 0;t<iWorkers;t++) {
+    threads.push_back(std::thread([&, t]() {
+      UVF uvfFile(wstrUVFName);
+      const TOCBlock* toc = uvfFile.Open(false, false, false)
+                            ? FindTOCBlock(uvfFile) : NULL;
+      if (!toc) {
+        bOpenFailed = true;
+        return;
+      }
+
+      std::vector<uint8_t> data;
+      for (uint64_t i = iNext++;i<vBricks.size() && !bOpenFailed;
+           i = iNext++) {
+        data.resize(BrickBytes(toc, vBricks[size_t(i)]));
+        toc->GetData(data.data(), vBricks[size_t(i)]);
+        visit(t, size_t(i), toc, data);
+      }
+      uvfFile.Close();
+    }));
+  }
+  for (size_t t = 0;t<threads.size();t++) threads[t].join();
+
+  if (bOpenFailed) {
+    strProblem = "unable to open the TOC block of " + strUVFName;
+    return false;
+  }
+  return true;
+}
+
+// Same as ForEachBrick for a TOC block that was just bricked into
+// strTempFile and is not part of a written UVF file yet. The bricker puts
+// the octree at the start of that file, so every worker opens it as an
+// octree of its own and only reads the brick metadata from toc.
+template<typename Visitor>
+bool ForEachBrickedBrick(const TOCBlock* toc, const std::string& strTempFile,
+                         const std::vector<UINT64VECTOR4>& vBricks,
+                         unsigned int iWorkers, Visitor visit,
+                         std::string& strProblem) {
+  if (vBricks.size() < iWorkers) iWorkers = unsigned(vBricks.size());
+  iWorkers = std::max(1u, iWorkers);
+
+  std::atomic<uint64_t> iNext(0);
+  std::atomic<bool> bOpenFailed(false);
+
+  std::vector<std::thread> threads;
+  for (unsigned int t = 0;t<iWorkers;t++) {
+    threads.push_back(std::thread([&, t]() {
+      ExtendedOctree octree;
+      if (!octree.Open(strTempFile, 0)) {
+        bOpenFailed = true;
+        return;
+      }
+
+      std::vector<uint8_t> data;
+      for (uint64_t i = iNext++;i<vBricks.size() && !bOpenFailed;
+           i = iNext++) {
+        data.resize(BrickBytes(toc, vBricks[size_t(i)]));
+        octree.GetBrickData(data.data(), vBricks[size_t(i)]);
+        visit(t, size_t(i), toc, data);
+      }
+      octree.Close();
+    }));
+  }
+  for (size_t t = 0;t<threads.size();t++) threads[t].join();
+
+  if (bOpenFailed) {
+    strProblem = "unable to open the bricked volume in " + strTempFile;
+    return false;
+  }
+  return true;
+}
+
+#endif // BRICKTOOLS_H
+
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2012 Interactive Visualization and Data Analysis Group
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
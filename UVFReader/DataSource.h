@@ -5,6 +5,9 @@
 #include <iostream>
 #include <cmath>
 #include <cstdint>
+#include <cstring>
+#include <atomic>
+#include <type_traits>
 
 #include "../Tuvok/Controller/Controller.h"
 
@@ -25,17 +28,144 @@
 #include "../Tuvok/IO/UVF/TOCBlock.h"
 #include "../Tuvok/IO/UVF/KeyValuePairDataBlock.h"
 
+#include "MandelbulbKernel.h"
+#include "ParallelTools.h"
+#include "SyntheticVolumes.h"
+#include "UVFChecksum.h"
+#include "VolumeStatistics.h"
+#include "HistogramTools.h"
+
 using namespace std;
 
 enum ECreationType {
   CT_FRACTAL,
   CT_CONST_VALUE,
   CT_RANDOM,
-  CT_SPHERE
+  CT_SPHERE,
+  CT_NOISE,
+  CT_PHANTOM,
+  CT_BLOBS,
+  CT_GRADIENT
 };
 
 static const double bulbSize = 2.25;
 
+// parameters shared by all volume generators
+struct GeneratorParams {
+  uint32_t iIterations; // fractal iterations or constant value
+  size_t   iFastLanes;  // > 0 selects the trig-free fractal kernel
+  uint64_t iSeed;       // seed of the random generators
+  double   fFrequency;  // features along one axis (synthetic volumes)
+  double   fSparsity;   // fraction of empty space (synthetic volumes)
+};
+
+void ReportCreationType(ECreationType eCreationType,
+                        const GeneratorParams& params) {
+  switch (eCreationType) {
+    case CT_FRACTAL :     MESSAGE("Generating a fractal"); break;
+    case CT_SPHERE :      MESSAGE("Generating a sphere"); break;
+    case CT_CONST_VALUE : MESSAGE("Generating zeroes"); break;
+    case CT_RANDOM :
+      MESSAGE("Generating noise (seed %llu)",
+              static_cast<unsigned long long>(params.iSeed));
+      break;
+    default : {
+      const char* names[] = {"gradient noise", "a CT phantom",
+                             "particle blobs", "a gradient field"};
+      MESSAGE("Generating %s (frequency %g, sparsity %g, seed %llu)",
+              names[eCreationType-CT_NOISE], params.fFrequency,
+              params.fSparsity, static_cast<unsigned long long>(params.iSeed));
+      break;
+    }
+  }
+}
+
+// IEEE 754 binary16 conversion with round to nearest even, overflow to
+// infinity and gradual underflow
+inline uint16_t FloatToHalf(float f) {
+  uint32_t x;
+  std::memcpy(&x, &f, sizeof(x));
+  const uint16_t sign = uint16_t((x >> 16) & 0x8000);
+  const uint32_t a = x & 0x7FFFFFFF;
+
+  if (a >= 0x7F800000)                        // inf and NaN
+    return uint16_t(sign | 0x7C00 | (a > 0x7F800000 ? 0x200 : 0));
+  if (a >= 0x477FF000)                        // rounds to 65520 and up
+    return uint16_t(sign | 0x7C00);
+  if (a >= 0x38800000)                        // normal
+    return uint16_t(sign | ((a + 0xFFF + ((a >> 13) & 1) - 0x38000000) >> 13));
+  if (a < 0x33000000)                         // rounds to zero
+    return sign;
+
+  // subnormal: the value in units of 2^-24
+  const uint32_t iShift = 126 - (a >> 23);
+  const uint32_t m = (a & 0x7FFFFF) | 0x800000;
+  uint32_t h = m >> iShift;
+  const uint32_t iRest = m & ((1u << iShift) - 1);
+  const uint32_t iHalfway = 1u << (iShift - 1);
+  if (iRest > iHalfway || (iRest == iHalfway && (h & 1))) h++;
+  return uint16_t(sign | h);
+}
+
+// A half float voxel. There is no arithmetic on it, the generators compute
+// VoxelType<T>::Compute values and only the output is rounded.
+struct HalfFloat {
+  uint16_t bits;
+};
+
+template<typename T>
+struct VoxelType {
+  typedef T Compute;
+  static T Store(T v) { return v; }
+};
+
+template<>
+struct VoxelType<HalfFloat> {
+  typedef float Compute;
+  static HalfFloat Store(float v) {
+    HalfFloat h = {FloatToHalf(v)};
+    return h;
+  }
+};
+
+// Integer volumes span the range of their type, floating point volumes
+// are normalized to [0,1] like most real float data. Fractals store the
+// iteration count in either case.
+template<typename T>
+double FullScale() {
+  return std::is_floating_point<T>::value
+           ? 1.0 : double(std::numeric_limits<T>::max());
+}
+
+// default fractal iteration count (and constant value); capped for the
+// wide types that could otherwise iterate for billions of steps
+template<typename T>
+uint32_t DefaultIterations() {
+  return uint32_t(std::min(double(std::numeric_limits<T>::max())-1.0,
+                           65534.0));
+}
+
+template<typename T>
+T ClampToValue(double v) {
+  return static_cast<T>(std::max(0.0, std::min(v, FullScale<T>())));
+}
+
+// maps a normalized generator result to the full range of T
+template<typename T>
+T NormalizedToValue(double v) {
+  return ClampToValue<T>(v * FullScale<T>());
+}
+
+template<typename T>
+T RandomToValue(uint64_t iRandom, std::true_type /* integral */) {
+  return T(iRandom % std::numeric_limits<T>::max());
+}
+
+template<typename T>
+T RandomToValue(uint64_t iRandom, std::false_type /* floating point */) {
+  return T(double(iRandom >> 11) * (1.0/9007199254740992.0));
+}
+
 double radius(double x, double y, double z)
 {
   return std::sqrt(x*x + y*y + z*z);
@@ -140,92 +270,61 @@ void FillBrick(LargeRAWFile_ptr pDummyData, T value, const UINT64VECTOR3& vOffse
   }
 }
 
+// Compares the six faces of a block against value and stops at the first
+// voxel that differs. The faces are sampled coarse to fine: every level
+// halves the sample spacing and only evaluates the voxels the coarser
+// levels have not seen yet, so most non-uniform blocks are rejected after a
+// handful of evaluations while a uniform block still costs exactly one
+// evaluation per face voxel. All threads share one cancellation flag.
 template<typename T>
-bool CheckBlockBoundary(T value, T iIterations, const UINT64VECTOR3& vOffset, const UINT64VECTOR3& vSize, const UINT64VECTOR3& vTotalSize) {
-  bool abort = false;
-  uint64_t zb = 0;
-  for (uint64_t y = 0;y<vSize.y;y++) {
-    #pragma omp parallel for
-    for (int64_t x = 0;x<int64_t(vSize.x);x++) {
-      if ( !abort && ComputeMandelbulb<T>(vOffset.x + x, vOffset.y + y, vOffset.z + zb, 8, iIterations, 100.0, vTotalSize)  != value ) {
-        abort = true;
-        #pragma omp flush (abort)
-      }
-    }
-  }
-  if (abort) return false;
-
-  zb = vSize.z-1;
-  for (uint64_t y = 0;y<vSize.y;y++) {
-    #pragma omp parallel for
-    for (int64_t x = 0;x<int64_t(vSize.x);x++) {
-      if ( !abort && ComputeMandelbulb<T>(vOffset.x + x, vOffset.y + y, vOffset.z + zb, 8, iIterations, 100.0, vTotalSize)  != value ) {
-        abort = true;
-        #pragma omp flush (abort)
-      }
+bool CheckBlockBoundary(T value, T iIterations, const UINT64VECTOR3& vOffset, const UINT64VECTOR3& vSize, const UINT64VECTOR3& vTotalSize, bool bParallel) {
+  const uint64_t size[3] = {vSize.x, vSize.y, vSize.z};
+
+  uint64_t iTopStride = 1;
+  while (iTopStride*2 < vSize.maxVal()) iTopStride *= 2;
+
+  std::atomic<bool> bMismatch(false);
+  for (uint64_t s = iTopStride;s>0;s/=2) {
+    // face f lies at the low (even f) or high (odd f) end of axis f/2 and
+    // spans the other two axes, iFirst[f] is its first sample index
+    int64_t iFirst[7];
+    iFirst[0] = 0;
+    for (int f = 0;f<6;f++) {
+      const uint64_t u = size[(f/2+1)%3], v = size[(f/2+2)%3];
+      iFirst[f+1] = iFirst[f] + int64_t(((u+s-1)/s)*((v+s-1)/s));
     }
-  }
-  if (abort) return false;
-
-  uint64_t yb = 0;
-  for (uint64_t z = 0;z<vSize.z;z++) {
-    #pragma omp parallel for
-    for (int64_t x = 0;x<int64_t(vSize.x);x++) {
-      if ( !abort && ComputeMandelbulb<T>(vOffset.x + x, vOffset.y + yb, vOffset.z + z, 8, iIterations, 100.0, vTotalSize)  != value ) {
-        abort = true;
-        #pragma omp flush (abort)
-      }
-    }
-  }
-  if (abort) return false;
-
-  yb = vSize.y-1;
-  for (uint64_t z = 0;z<vSize.z;z++) {
-    #pragma omp parallel for
-    for (int64_t x = 0;x<int64_t(vSize.x);x++) {
-      if ( !abort && ComputeMandelbulb<T>(vOffset.x + x, vOffset.y + yb, vOffset.z + z, 8, iIterations, 100.0, vTotalSize)  != value ) {
-        abort = true;
-        #pragma omp flush (abort)
-      }
-    }
-  }
-  if (abort) return false;
-
-  uint64_t xb = 0;
-  for (uint64_t z = 0;z<vSize.z;z++) {
-    #pragma omp parallel for
-    for (int64_t y = 0;y<int64_t(vSize.y);y++) {
-      if ( !abort && ComputeMandelbulb<T>(vOffset.x + xb, vOffset.y + y, vOffset.z + z, 8, iIterations, 100.0, vTotalSize)  != value ) {
-        abort = true;
-        #pragma omp flush (abort)
-      }
+    const int64_t iCount = iFirst[6];
+
+    #pragma omp parallel for schedule(dynamic, 64) if(bParallel && iCount > 64)
+    for (int64_t k = 0;k<iCount;k++) {
+      if (bMismatch.load(std::memory_order_relaxed)) continue;
+
+      int f = 0;
+      while (k >= iFirst[f+1]) f++;
+      const int w = f/2, u = (w+1)%3, v = (w+2)%3;
+      const uint64_t r = uint64_t(k-iFirst[f]);
+      const uint64_t nu = (size[u]+s-1)/s;
+      uint64_t p[3];
+      p[u] = (r%nu)*s;
+      p[v] = (r/nu)*s;
+      p[w] = (f%2) ? size[w]-1 : 0;
+
+      // already evaluated on a coarser level
+      if (s < iTopStride && p[u]%(2*s) == 0 && p[v]%(2*s) == 0) continue;
+
+      if (ComputeMandelbulb<T>(vOffset.x + p[0], vOffset.y + p[1], vOffset.z + p[2], 8, iIterations, 100.0, vTotalSize) != value)
+        bMismatch.store(true, std::memory_order_relaxed);
     }
+    if (bMismatch.load()) return false;
   }
-  if (abort) return false;
-
-  xb = vSize.x-1;
-  for (uint64_t z = 0;z<vSize.z;z++) {
-    #pragma omp parallel for
-    for (int64_t y = 0;y<int64_t(vSize.y);y++) {
-      if ( !abort && ComputeMandelbulb<T>(vOffset.x + xb, vOffset.y + y, vOffset.z + z, 8, iIterations, 100.0, vTotalSize)  != value ) {
-        abort = true;
-        #pragma omp flush (abort)
-      }
-    }
-  }
-  if (abort) return false;
 
   return true;
 }
 
-
+// evaluates the eight corner voxels of a block, the corner with the given
+// index is known from the parent block and is not recomputed
 template<typename T>
-void ComputeFractalFast(LargeRAWFile_ptr pDummyData, const UINT64VECTOR3& vOffset, const UINT64VECTOR3& vSize, const UINT64VECTOR3& vTotalSize, const ProgressTimer& timer, uint32_t index=8, T value=0, int depth=1, double completed=0) {
-
-  // compute the eight boundary voxels
-  T iIterations = std::numeric_limits<T>::max()-1;
-
-  std::array<T,8> val;
+void ComputeBlockCorners(std::array<T,8>& val, T iIterations, const UINT64VECTOR3& vOffset, const UINT64VECTOR3& vSize, const UINT64VECTOR3& vTotalSize, uint32_t index, T value, bool bParallel) {
   const std::array<DOUBLEVECTOR3,8> pos = {{
     DOUBLEVECTOR3(bulbSize * (vOffset.x)/(vTotalSize.x-1) - bulbSize/2.0,               // 0
                   bulbSize * (vOffset.y)/(vTotalSize.y-1) - bulbSize/2.0,               // 0
@@ -260,146 +359,641 @@ void ComputeFractalFast(LargeRAWFile_ptr pDummyData, const UINT64VECTOR3& vOffse
                   bulbSize * (vOffset.z+(vSize.z-1))/(vTotalSize.z-1) - bulbSize/2.0),  // 1
   }};
 
-  #pragma omp parallel for
+  #pragma omp parallel for if(bParallel)
   for (int i = 0;i<8;++i) {
     val[i] = (index != uint32_t(i)) ? ComputeMandelbulb<T>(pos[i].x,pos[i].y,pos[i].z, 8, iIterations, 100.0) : value;
   }
+}
+
+// true if the block can be filled with val[0] without subdividing it
+template<typename T>
+bool IsUniformBlock(const std::array<T,8>& val, T iIterations, const UINT64VECTOR3& vOffset, const UINT64VECTOR3& vSize, const UINT64VECTOR3& vTotalSize, bool bParallel) {
+  return vSize.x > 4 && vSize.y > 4 && vSize.z > 4 && val[1] == val[0] && val[2] == val[0] && val[3] == val[0] && val[4] == val[0] &&
+         val[5] == val[0] && val[6] == val[0] && val[7] == val[0] &&
+         CheckBlockBoundary(val[0], iIterations, vOffset, vSize, vTotalSize, bParallel);
+}
+
+// offset of octant i of a block
+inline UINT64VECTOR3 OctantOffset(const UINT64VECTOR3& vOffset, const UINT64VECTOR3& vSize, uint32_t i) {
+  return UINT64VECTOR3(vOffset.x + ((i & 1) ? vSize.x/2 : 0),
+                       vOffset.y + ((i & 2) ? vSize.y/2 : 0),
+                       vOffset.z + ((i & 4) ? vSize.z/2 : 0));
+}
+
+// An in memory part of the volume the hierarchical generator writes into,
+// so the leaves of a subtree end up in one buffer instead of many tiny
+// writes to the file.
+template<typename T>
+struct FractalBrick {
+  FractalBrick(const UINT64VECTOR3& vOffset, const UINT64VECTOR3& vSize) :
+    vOffset(vOffset), vSize(vSize), data(size_t(vSize.volume())) {}
+
+  void Fill(T value, const UINT64VECTOR3& vPos, const UINT64VECTOR3& vExtent) {
+    for (uint64_t z = 0;z<vExtent.z;z++) {
+      for (uint64_t y = 0;y<vExtent.y;y++) {
+        T* line = &data[size_t(Index(UINT64VECTOR3(vPos.x, vPos.y+y, vPos.z+z)))];
+        std::fill(line, line+vExtent.x, value);
+      }
+    }
+  }
+
+  T& At(const UINT64VECTOR3& vPos) { return data[size_t(Index(vPos))]; }
+
+  uint64_t Index(const UINT64VECTOR3& vPos) const {
+    return (vPos.x-vOffset.x) +
+           (vPos.y-vOffset.y)*vSize.x +
+           (vPos.z-vOffset.z)*vSize.x*vSize.y;
+  }
 
+  UINT64VECTOR3  vOffset;
+  UINT64VECTOR3  vSize;
+  std::vector<T> data;
+};
+
+// serial octree recursion for one subtree, everything goes into the brick
+template<typename T>
+void ComputeFractalBrick(FractalBrick<T>& brick, const UINT64VECTOR3& vOffset, const UINT64VECTOR3& vSize, const UINT64VECTOR3& vTotalSize, T iIterations, uint32_t index, T value) {
+  std::array<T,8> val;
+  ComputeBlockCorners<T>(val, iIterations, vOffset, vSize, vTotalSize, index, value, false);
 
   if (vSize.x == 2 && vSize.y == 2 && vSize.z == 2) {
-    std::array<T,2> l;
-    UINT64VECTOR3 vPos;
-
-    l[0] = val[0]; l[1] = val[1];
-    vPos = vOffset;
-    WriteLineAtPos<T>(pDummyData, 2, vPos, vTotalSize, l.data());
-    l[0] = val[2]; l[1] = val[3];
-    vPos = UINT64VECTOR3(vOffset.x, vOffset.y+1, vOffset.z);
-    WriteLineAtPos<T>(pDummyData, 2, vPos, vTotalSize, l.data());
-    l[0] = val[4]; l[1] = val[5];
-    vPos = UINT64VECTOR3(vOffset.x, vOffset.y, vOffset.z+1);
-    WriteLineAtPos<T>(pDummyData, 2, vPos, vTotalSize, l.data());
-    l[0] = val[6]; l[1] = val[7];
-    vPos = UINT64VECTOR3(vOffset.x, vOffset.y+1, vOffset.z+1);
-    WriteLineAtPos<T>(pDummyData, 2, vPos, vTotalSize, l.data());
+    for (uint32_t i = 0;i<8;++i)
+      brick.At(OctantOffset(vOffset, vSize, i)) = val[i];
     return;
   }
 
-
-  if (vSize.x > 4 && vSize.y > 4 && vSize.z > 4 && val[1] == val[0] && val[2] == val[0] && val[3] == val[0] && val[4] == val[0] &&
-      val[5] == val[0] && val[6] == val[0] && val[7] == val[0] &&
-      CheckBlockBoundary(val[0], iIterations, vOffset, vSize, vTotalSize) ) {
-    //MESSAGE("Empty Brick @ %i, %i, %i of size %ix%ix%i\n", vOffset.x, vOffset.y, vOffset.z, vSize.x, vSize.y, vSize.z);
-    FillBrick(pDummyData, val[0], vOffset, vSize, vTotalSize);
+  if (IsUniformBlock(val, iIterations, vOffset, vSize, vTotalSize, false)) {
+    brick.Fill(val[0], vOffset, vSize);
     return;
   }
 
-  UINT64VECTOR3 vPos = vOffset;
-  ComputeFractalFast<T>(pDummyData, vPos, vSize/2, vTotalSize, timer, 0, val[0], depth+1, completed);
-  completed += 1.0/pow(8.0, depth);
+  for (uint32_t i = 0;i<8;++i)
+    ComputeFractalBrick<T>(brick, OctantOffset(vOffset, vSize, i), vSize/2, vTotalSize, iIterations, i, val[i]);
+}
 
-  vPos = vOffset; vPos.x += vSize.x/2;
-  ComputeFractalFast<T>(pDummyData, vPos, vSize/2, vTotalSize, timer, 1, val[1], depth+1, completed);
-  completed += 1.0/pow(8.0, depth);
+struct FractalTask {
+  UINT64VECTOR3 vOffset;
+  uint32_t      index;
+  uint64_t      value;
+};
+
+// Descends the top of the octree on the calling thread (with parallel
+// corner and boundary evaluation) until blocks reach the task size. Uniform
+// blocks found on the way are written to the file directly, all others
+// become independent tasks. Returns the number of voxels written.
+template<typename T>
+uint64_t CollectFractalTasks(LargeRAWFile_ptr pDummyData, std::vector<FractalTask>& tasks, const UINT64VECTOR3& vOffset, const UINT64VECTOR3& vSize, const UINT64VECTOR3& vTotalSize, const UINT64VECTOR3& vTaskSize, T iIterations, uint32_t index, T value) {
+  if (vSize == vTaskSize) {
+    FractalTask t = {vOffset, index, uint64_t(value)};
+    tasks.push_back(t);
+    return 0;
+  }
 
-  vPos = vOffset; vPos.y += vSize.y/2;
-  ComputeFractalFast<T>(pDummyData, vPos, vSize/2, vTotalSize, timer, 2, val[2], depth+1, completed);
-  completed += 1.0/pow(8.0, depth);
+  std::array<T,8> val;
+  ComputeBlockCorners<T>(val, iIterations, vOffset, vSize, vTotalSize, index, value, true);
 
-  vPos = vOffset; vPos.x += vSize.x/2; vPos.y += vSize.y/2;
-  ComputeFractalFast<T>(pDummyData, vPos, vSize/2, vTotalSize, timer, 3, val[3], depth+1, completed);
-  completed += 1.0/pow(8.0, depth);
+  if (IsUniformBlock(val, iIterations, vOffset, vSize, vTotalSize, true)) {
+    FillBrick(pDummyData, val[0], vOffset, vSize, vTotalSize);
+    return vSize.volume();
+  }
 
-  vPos = vOffset; vPos.z += vSize.z/2;
-  ComputeFractalFast<T>(pDummyData, vPos, vSize/2, vTotalSize, timer, 4, val[4], depth+1, completed);
-  completed += 1.0/pow(8.0, depth);
+  uint64_t iWritten = 0;
+  for (uint32_t i = 0;i<8;++i)
+    iWritten += CollectFractalTasks<T>(pDummyData, tasks, OctantOffset(vOffset, vSize, i), vSize/2, vTotalSize, vTaskSize, iIterations, i, val[i]);
+  return iWritten;
+}
 
-  vPos = vOffset; vPos.x += vSize.x/2; vPos.z += vSize.z/2;
-  ComputeFractalFast<T>(pDummyData, vPos, vSize/2, vTotalSize, timer, 5, val[5], depth+1, completed);
-  completed += 1.0/pow(8.0, depth);
+// largest edge length of a task brick, keeps the reorder buffer small
+static const uint64_t iMaxFractalTaskSize = 128;
 
-  vPos = vOffset; vPos.z += vSize.z/2; vPos.y += vSize.y/2;
-  ComputeFractalFast<T>(pDummyData, vPos, vSize/2, vTotalSize, timer, 6, val[6], depth+1, completed);
-  completed += 1.0/pow(8.0, depth);
+// Writes the bricks of consecutive tasks of one row of the volume (same y
+// and z offset, ascending x). Bricks that are adjacent in x are written as
+// one run per line, runs spanning the whole width as one write per slice.
+template<typename T>
+bool WriteFractalRow(LargeRAWFile_ptr pDummyData, const FractalTask* pTasks,
+                     const std::vector<std::vector<uint8_t>>& vBricks,
+                     const UINT64VECTOR3& vTaskSize,
+                     const UINT64VECTOR3& vTotalSize) {
+  std::vector<T> run;
+  size_t iFirst = 0;
+  while (iFirst < vBricks.size()) {
+    size_t iEnd = iFirst+1;
+    while (iEnd < vBricks.size() &&
+           pTasks[iEnd].vOffset.x == pTasks[iEnd-1].vOffset.x + vTaskSize.x)
+      iEnd++;
+    const UINT64VECTOR3& vOffset = pTasks[iFirst].vOffset;
+    const uint64_t iRunLength = (iEnd-iFirst)*vTaskSize.x;
+    const uint64_t iLines = (iRunLength == vTotalSize.x) ? vTaskSize.y : 1;
+    run.resize(size_t(iRunLength*iLines));
+
+    for (uint64_t z = 0;z<vTaskSize.z;z++) {
+      for (uint64_t y = 0;y<vTaskSize.y;y += iLines) {
+        for (uint64_t l = 0;l<iLines;l++) {
+          for (size_t b = iFirst;b<iEnd;b++) {
+            const T* pBrick = reinterpret_cast<const T*>(vBricks[b].data());
+            std::memcpy(&run[size_t(l*iRunLength + (b-iFirst)*vTaskSize.x)],
+                        pBrick + (z*vTaskSize.y + y + l)*vTaskSize.x,
+                        size_t(vTaskSize.x*sizeof(T)));
+          }
+        }
+        const uint64_t iPos = vOffset.x + (vOffset.y+y)*vTotalSize.x +
+                              (vOffset.z+z)*vTotalSize.x*vTotalSize.y;
+        const size_t iBytes = run.size()*sizeof(T);
+        pDummyData->SeekPos(iPos*sizeof(T));
+        if (pDummyData->WriteRAW(reinterpret_cast<const uint8_t*>(run.data()),
+                                 iBytes) != iBytes) {
+          T_ERROR("Failed to write the subtree at %llu %llu %llu.",
+                  static_cast<unsigned long long>(vOffset.x),
+                  static_cast<unsigned long long>(vOffset.y),
+                  static_cast<unsigned long long>(vOffset.z+z));
+          return false;
+        }
+      }
+    }
+    iFirst = iEnd;
+  }
+  return true;
+}
+
+// Hierarchical generation of a power of two cube. The octree is descended
+// on the calling thread down to a task size, then the remaining subtrees
+// are computed on a pool of worker threads, each into its own in memory
+// brick that is written back by the calling thread.
+template<typename T>
+bool ComputeFractalFast(LargeRAWFile_ptr pDummyData, const UINT64VECTOR3& vTotalSize, const ProgressTimer& timer) {
+  const T iIterations = T(DefaultIterations<T>());
+  const unsigned int iWorkers = WorkerCount();
+
+  // shrink the tasks until every worker gets a few of them
+  uint64_t iTaskSize = std::min(vTotalSize.x, iMaxFractalTaskSize);
+  while (iTaskSize > 16 &&
+         (vTotalSize.x/iTaskSize)*(vTotalSize.x/iTaskSize)*(vTotalSize.x/iTaskSize) < 4*iWorkers)
+    iTaskSize /= 2;
+  const UINT64VECTOR3 vTaskSize(iTaskSize, iTaskSize, iTaskSize);
+
+  std::vector<FractalTask> tasks;
+  uint64_t iCompleted = CollectFractalTasks<T>(pDummyData, tasks, UINT64VECTOR3(0,0,0), vTotalSize, vTotalSize, vTaskSize, iIterations, 8, 0);
+  MESSAGE("%u subtrees of size %u left for parallel generation.", static_cast<unsigned int>(tasks.size()), static_cast<unsigned int>(iTaskSize));
+
+  // in file order, so the tasks of a row of the volume are consumed one
+  // after the other and neighbours can be written together
+  std::sort(tasks.begin(), tasks.end(),
+            [](const FractalTask& a, const FractalTask& b) {
+    if (a.vOffset.z != b.vOffset.z) return a.vOffset.z < b.vOffset.z;
+    if (a.vOffset.y != b.vOffset.y) return a.vOffset.y < b.vOffset.y;
+    return a.vOffset.x < b.vOffset.x;
+  });
+
+  // bricks of the current row, the first of them belongs to task iRowStart
+  std::vector<std::vector<uint8_t>> row;
+  size_t iRowStart = 0;
+
+  return ProduceOrdered(tasks.size(), iWorkers, 2*iWorkers,
+    [&](uint64_t i, std::vector<uint8_t>& buffer) {
+      FractalBrick<T> brick(tasks[size_t(i)].vOffset, vTaskSize);
+      ComputeFractalBrick<T>(brick, brick.vOffset, vTaskSize, vTotalSize, iIterations, tasks[size_t(i)].index, T(tasks[size_t(i)].value));
+      buffer.resize(brick.data.size()*sizeof(T));
+      std::memcpy(buffer.data(), brick.data.data(), buffer.size());
+    },
+    [&](uint64_t i, std::vector<uint8_t>& buffer) {
+      row.push_back(std::vector<uint8_t>());
+      row.back().swap(buffer);
+      const UINT64VECTOR3& vOffset = tasks[size_t(i)].vOffset;
+      if (i+1 < tasks.size() &&
+          tasks[size_t(i+1)].vOffset.y == vOffset.y &&
+          tasks[size_t(i+1)].vOffset.z == vOffset.z)
+        return true;
+
+      if (!WriteFractalRow<T>(pDummyData, &tasks[iRowStart], row, vTaskSize,
+                              vTotalSize))
+        return false;
+      iCompleted += row.size()*vTaskSize.volume();
+      iRowStart = size_t(i+1);
+      row.clear();
+      const double completed = double(iCompleted)/vTotalSize.volume();
+      MESSAGE(" %.3f%% completed (%s)", completed*100.0, timer.GetProgressMessage(completed).c_str());
+      return true;
+    });
+}
+
+template<typename T, ECreationType eCreationType>
+T GenerateVoxel(uint64_t x, uint64_t y, uint64_t z,
+                const UINT64VECTOR3& vSize, const GeneratorParams& params) {
+  switch (eCreationType) {
+    case CT_FRACTAL:
+      return ComputeMandelbulb(bulbSize * static_cast<double>(x)/
+                                     (vSize.x-1) - bulbSize/2.0,
+                               bulbSize * static_cast<double>(y)/
+                                     (vSize.y-1) - bulbSize/2.0,
+                               bulbSize * static_cast<double>(z)/
+                                     (vSize.z-1) - bulbSize/2.0,
+                               8,
+                               T(params.iIterations),
+                               100.0);
+    case CT_SPHERE:
+      return ClampToValue<T>((0.5f-(0.5f-FLOATVECTOR3(float(x),
+                                                      float(y),
+                                                      float(z))/
+                                        FLOATVECTOR3(vSize)).length())*
+                                        float(FullScale<T>())*2);
+    case CT_CONST_VALUE:
+      return T(params.iIterations);
+    case CT_RANDOM:
+      return RandomToValue<T>(CounterRandom(x + vSize.x*(y + vSize.y*z),
+                                            params.iSeed),
+                              std::is_integral<T>());
+    default:
+      break;
+  }
 
-  vPos = vOffset; vPos.x += vSize.x/2; vPos.y += vSize.y/2; vPos.z += vSize.z/2;
-  ComputeFractalFast<T>(pDummyData, vPos, vSize/2, vTotalSize, timer, 7, val[7], depth+1, completed);
-  completed += 1.0/pow(8.0, depth);
+  // the synthetic volumes sample at the voxel centers
+  const double px = (x+0.5)/vSize.x;
+  const double py = (y+0.5)/vSize.y;
+  const double pz = (z+0.5)/vSize.z;
+  switch (eCreationType) {
+    case CT_NOISE:
+      return NormalizedToValue<T>(NoiseValue(px, py, pz, params.fFrequency,
+                                             params.fSparsity, params.iSeed));
+    case CT_PHANTOM:
+      return NormalizedToValue<T>(PhantomValue(px, py, pz,
+                                               x + vSize.x*(y + vSize.y*z),
+                                               params.fFrequency,
+                                               params.fSparsity,
+                                               params.iSeed));
+    case CT_BLOBS:
+      return NormalizedToValue<T>(BlobValue(px, py, pz, params.fFrequency,
+                                            params.fSparsity, params.iSeed));
+    case CT_GRADIENT:
+      return NormalizedToValue<T>(GradientFieldValue(px, py, pz,
+                                                     params.fFrequency,
+                                                     params.fSparsity,
+                                                     params.iSeed));
+    default:
+      break;
+  }
+  return T(0);
+}
 
-  if (vSize.volume() >= 16*16*16)
-    MESSAGE(" %.3f%% completed (Depth=%i) (%s)", completed*100.0, depth, timer.GetProgressMessage(completed).c_str());
+// generates iCount voxels in scanline order starting at the linear voxel
+// index iFirst
+template<typename T, ECreationType eCreationType>
+void GenerateRange(T* pData, uint64_t iFirst, uint64_t iCount,
+                   const UINT64VECTOR3& vSize, const GeneratorParams& params) {
+  uint64_t x = iFirst % vSize.x;
+  uint64_t y = (iFirst / vSize.x) % vSize.y;
+  uint64_t z = iFirst / (vSize.x*vSize.y);
+
+  if (eCreationType == CT_FRACTAL && params.iFastLanes > 0) {
+    std::vector<double> sx, sy, sz;
+    for (uint64_t i = 0;i<iCount;) {
+      const uint64_t n = std::min(vSize.x-x, iCount-i);
+      sx.resize(size_t(n));
+      for (uint64_t k = 0;k<n;k++)
+        sx[k] = bulbSize * static_cast<double>(x+k)/(vSize.x-1) - bulbSize/2.0;
+      sy.assign(size_t(n),
+                bulbSize * static_cast<double>(y)/(vSize.y-1) - bulbSize/2.0);
+      sz.assign(size_t(n),
+                bulbSize * static_cast<double>(z)/(vSize.z-1) - bulbSize/2.0);
+      ComputeMandelbulb8Batch<T>(sx.data(), sy.data(), sz.data(), size_t(n),
+                                 T(params.iIterations), 100.0, pData+i,
+                                 params.iFastLanes);
+      i += n;
+      x = 0;
+      if (++y == vSize.y) { y = 0; z++; }
+    }
+    return;
+  }
 
+  for (uint64_t i = 0;i<iCount;i++) {
+    pData[i] = GenerateVoxel<T, eCreationType>(x, y, z, vSize, params);
+    if (++x == vSize.x) {
+      x = 0;
+      if (++y == vSize.y) { y = 0; z++; }
+    }
+  }
+}
 
+// fills slab with the iCount voxels in scanline order starting at the
+// linear voxel index iFirst
+template<typename T, ECreationType eCreationType>
+void GenerateSlab(std::vector<uint8_t>& slab, uint64_t iFirst, uint64_t iCount,
+                  const UINT64VECTOR3& vSize, const GeneratorParams& params) {
+  typedef typename VoxelType<T>::Compute C;
+  slab.resize(size_t(iCount*sizeof(T)));
+  if (std::is_same<T, C>::value) {
+    GenerateRange<C, eCreationType>(reinterpret_cast<C*>(slab.data()),
+                                    iFirst, iCount, vSize, params);
+  } else {
+    std::vector<C> values(static_cast<size_t>(iCount));
+    GenerateRange<C, eCreationType>(values.data(), iFirst, iCount,
+                                    vSize, params);
+    T* pData = reinterpret_cast<T*>(slab.data());
+    for (size_t i = 0;i<values.size();i++)
+      pData[i] = VoxelType<T>::Store(values[i]);
+  }
 }
 
+// target size of one slab handed from the generator threads to the writer
+static const uint64_t iTargetSlabBytes = 16*1024*1024;
+// upper bound for the slabs computed or waiting for the writer at any time,
+// slabs shrink (down to iMinSlabBytes) to keep all workers busy below it
+static const uint64_t iPendingSlabBytes = 512*1024*1024;
+static const uint64_t iMinSlabBytes = 1024*1024;
+
 template<typename T, ECreationType eCreationType>
-void GenerateVolumeData(UINT64VECTOR3 vSize, LargeRAWFile_ptr pDummyData,
-                        uint32_t iIterations, bool bHierarchical) {
+bool GenerateVolumeData(UINT64VECTOR3 vSize, LargeRAWFile_ptr pDummyData,
+                        GeneratorParams params, bool bHierarchical,
+                        bool bFastFractal) {
+  typedef typename VoxelType<T>::Compute C;
 
-  if (iIterations == 0)
-    iIterations = std::numeric_limits<T>::max()-1;
+  if (params.iIterations == 0)
+    params.iIterations = DefaultIterations<C>();
   ProgressTimer timer;
   timer.Start();
 
   // shortcut for fractals in an pow of two cube volume
   if (bHierarchical && eCreationType == CT_FRACTAL && vSize.x == vSize.y && vSize.y == vSize.z && vSize == vSize.makepow2()) {
     MESSAGE("Hierarchical Data Generation mode.");
+    if (bFastFractal)
+      MESSAGE("The fast fractal kernel is not used in hierarchical mode.");
     cout << endl;
-	  ComputeFractalFast<T>(pDummyData, UINT64VECTOR3(0,0,0), vSize, vSize, timer);
-	  return;
+    if (!std::is_same<T, C>::value) {
+      T_ERROR("Hierarchical generation does not support half floats.");
+      return false;
+    }
+    return ComputeFractalFast<C>(pDummyData, vSize, timer);
   }
 
-  std::vector<T> source(vSize.x);
-
-  for (uint64_t z = 0;z<vSize.z;z++) {
-    const double completed = (double)z/vSize.z;
-    MESSAGE("Generating Data %.3f%% completed (%s)",
-            100.0*completed, timer.GetProgressMessage(completed).c_str());
+  // Split the volume into slabs of consecutive voxels. The slabs are
+  // computed out of order on a pool of worker threads and written back in
+  // order with one large sequential write each. A slab holds whole
+  // z-slices when a slice fits into the slab budget and whole rows (or
+  // parts of one row) otherwise, so the pending slabs stay within
+  // iPendingSlabBytes no matter how large a slice is. Slabs are kept small
+  // enough that every worker gets a few of them even for small volumes.
+  const unsigned int iWorkers = WorkerCount();
+  const unsigned int iMaxPending = 2*iWorkers;
+  const uint64_t iSlabBudget =
+    std::max(iMinSlabBytes,
+             std::min(iTargetSlabBytes, iPendingSlabBytes/iMaxPending));
+  const uint64_t iBudgetVoxels = std::max<uint64_t>(1, iSlabBudget/sizeof(T));
+  const uint64_t iSliceVoxels = vSize.x*vSize.y;
+  const uint64_t iVoxelCount = iSliceVoxels*vSize.z;
+  uint64_t iSlabVoxels;
+  if (iSliceVoxels <= iBudgetVoxels)
+    iSlabVoxels = iSliceVoxels*std::max<uint64_t>(1,
+                    std::min<uint64_t>(iBudgetVoxels/iSliceVoxels,
+                                       vSize.z/(4*iWorkers)));
+  else if (vSize.x <= iBudgetVoxels)
+    iSlabVoxels = vSize.x*(iBudgetVoxels/vSize.x);
+  else
+    iSlabVoxels = iBudgetVoxels;
+  const uint64_t iSlabCount = (iVoxelCount+iSlabVoxels-1)/iSlabVoxels;
+
+  params.iFastLanes = 0;
+  if (eCreationType == CT_FRACTAL && bFastFractal) {
+    params.iFastLanes = MandelbulbLaneCount();
+    MESSAGE("Using the trig-free fractal kernel (%u lanes).",
+            static_cast<unsigned int>(params.iFastLanes));
+  }
 
-    for (uint64_t y = 0;y<vSize.y;y++) {
-      #pragma omp parallel for
-      for (int64_t x = 0;x<int64_t(vSize.x);x++) {
-        switch (eCreationType) {
-          case CT_FRACTAL: {
-            source[x] =
-              ComputeMandelbulb(bulbSize * static_cast<double>(x)/
-                                                     (vSize.x-1) - bulbSize/2.0,
-                                               bulbSize * static_cast<double>(y)/
-                                                     (vSize.y-1) - bulbSize/2.0,
-                                               bulbSize * static_cast<double>(z)/
-                                                     (vSize.z-1) - bulbSize/2.0,
-                                               8,
-                                               T(iIterations),
-                                               100.0);
-            }
-            break;
-          case CT_SPHERE:
-            source[x] =
-            static_cast<T>(std::max(0.0f,
-                                   (0.5f-(0.5f-FLOATVECTOR3(float(x),
-                                                            float(y),
-                                                            float(z))/
-                                              FLOATVECTOR3(vSize)).length())*
-                                              std::numeric_limits<T>::max()*2));
-            break;
-          case CT_CONST_VALUE:
-            source[x] = T(iIterations);
-            break;
-          case CT_RANDOM:
-            source[x] = rand()%std::numeric_limits<T>::max();
-            break;
-        }
+  pDummyData->SeekStart();
+  return ProduceOrdered(iSlabCount, iWorkers, iMaxPending,
+    [&](uint64_t i, std::vector<uint8_t>& slab) {
+      const uint64_t iFirst = i*iSlabVoxels;
+      GenerateSlab<T, eCreationType>(slab, iFirst,
+                                     std::min(iSlabVoxels, iVoxelCount-iFirst),
+                                     vSize, params);
+    },
+    [&](uint64_t i, const std::vector<uint8_t>& slab) {
+      if (pDummyData->WriteRAW(slab.data(), slab.size()) != slab.size()) {
+        T_ERROR("Failed to write slab %llu of the volume.",
+                static_cast<unsigned long long>(i));
+        return false;
       }
-      pDummyData->WriteRAW((uint8_t*)(source.data()), vSize.x*sizeof(T));
+      const double completed = double(i+1)/iSlabCount;
+      MESSAGE("Generating Data %.3f%% completed (%s)",
+              100.0*completed, timer.GetProgressMessage(completed).c_str());
+      return true;
+    });
+}
+
+template<typename T>
+bool GenerateVolume(ECreationType eCreationType, const UINT64VECTOR3& vSize,
+                    LargeRAWFile_ptr pDummyData, GeneratorParams params,
+                    bool bHierarchical, bool bFastFractal) {
+  ReportCreationType(eCreationType, params);
+  switch (eCreationType) {
+    case CT_FRACTAL :
+      return GenerateVolumeData<T, CT_FRACTAL>(vSize, pDummyData, params,
+                                               bHierarchical, bFastFractal);
+    case CT_SPHERE :
+      return GenerateVolumeData<T, CT_SPHERE>(vSize, pDummyData, params,
+                                              bHierarchical, bFastFractal);
+    case CT_CONST_VALUE :
+      params.iIterations = 0;
+      return GenerateVolumeData<T, CT_CONST_VALUE>(vSize, pDummyData, params,
+                                                   bHierarchical, bFastFractal);
+    case CT_RANDOM :
+      return GenerateVolumeData<T, CT_RANDOM>(vSize, pDummyData, params,
+                                              bHierarchical, bFastFractal);
+    case CT_NOISE :
+      return GenerateVolumeData<T, CT_NOISE>(vSize, pDummyData, params,
+                                             bHierarchical, bFastFractal);
+    case CT_PHANTOM :
+      return GenerateVolumeData<T, CT_PHANTOM>(vSize, pDummyData, params,
+                                               bHierarchical, bFastFractal);
+    case CT_BLOBS :
+      return GenerateVolumeData<T, CT_BLOBS>(vSize, pDummyData, params,
+                                             bHierarchical, bFastFractal);
+    case CT_GRADIENT :
+      return GenerateVolumeData<T, CT_GRADIENT>(vSize, pDummyData, params,
+                                                bHierarchical, bFastFractal);
+  }
+  T_ERROR("Unknown volume type %u", static_cast<unsigned int>(eCreationType));
+  return false;
+}
+
+// A read-only stand-in for the intermediate RAW file: every read computes
+// the requested voxels on the fly, so the bricker can pull its input
+// straight from the generator without the volume ever touching the disk.
+// Reads are split into chunks that are generated in parallel.
+template<typename T, ECreationType eCreationType>
+class ProceduralRAWFile : public LargeRAWFile {
+public:
+  ProceduralRAWFile(const std::string& strName, const UINT64VECTOR3& vSize,
+                    const GeneratorParams& params) :
+    LargeRAWFile(strName),
+    m_vSize(vSize),
+    m_Params(params),
+    m_iPos(0)
+  {
+    if (m_Params.iIterations == 0)
+      m_Params.iIterations = DefaultIterations<T>();
+  }
+
+  virtual bool Open(bool bReadWrite=false) {
+    m_iPos = 0;
+    return !bReadWrite;
+  }
+  virtual bool IsOpen() const { return true; }
+  virtual bool IsWritable() const { return false; }
+  virtual void Close() {}
+  virtual bool Delete() { return true; }
+  virtual uint64_t GetCurrentSize() { return m_vSize.volume()*sizeof(T); }
+
+  virtual void SeekStart() { m_iPos = 0; }
+  virtual uint64_t SeekEnd() { return m_iPos = GetCurrentSize(); }
+  virtual uint64_t GetPos() { return m_iPos; }
+  virtual void SeekPos(uint64_t iPos) { m_iPos = iPos; }
+
+  virtual size_t ReadRAW(unsigned char* pData, uint64_t iCount) {
+    const uint64_t iSize = GetCurrentSize();
+    if (m_iPos >= iSize) return 0;
+    iCount = std::min(iCount, iSize-m_iPos);
+
+    // reads need not start or end on a voxel boundary
+    const uint64_t iFirst = m_iPos/sizeof(T);
+    const uint64_t iEnd = (m_iPos+iCount+sizeof(T)-1)/sizeof(T);
+    std::vector<T> voxels(size_t(iEnd-iFirst));
+
+    const int64_t iChunkSize = 4096;
+    const int64_t iChunks = (int64_t(voxels.size())+iChunkSize-1)/iChunkSize;
+    #pragma omp parallel for schedule(dynamic)
+    for (int64_t c = 0;c<iChunks;c++) {
+      const uint64_t iStart = uint64_t(c*iChunkSize);
+      GenerateRange<T, eCreationType>(&voxels[size_t(iStart)], iFirst+iStart,
+                                      std::min<uint64_t>(iChunkSize,
+                                                         voxels.size()-iStart),
+                                      m_vSize, m_Params);
     }
+
+    std::memcpy(pData, reinterpret_cast<const uint8_t*>(voxels.data()) +
+                       (m_iPos-iFirst*sizeof(T)), size_t(iCount));
+    m_iPos += iCount;
+    return size_t(iCount);
+  }
+
+  virtual size_t WriteRAW(const unsigned char*, uint64_t) { return 0; }
+
+private:
+  UINT64VECTOR3   m_vSize;
+  GeneratorParams m_Params;
+  uint64_t        m_iPos;
+};
+
+template<typename T>
+LargeRAWFile_ptr CreateProceduralSource(const std::string& strName,
+                                        ECreationType eCreationType,
+                                        const UINT64VECTOR3& vSize,
+                                        GeneratorParams params,
+                                        bool bFastFractal) {
+  ReportCreationType(eCreationType, params);
+  params.iFastLanes = 0;
+  switch (eCreationType) {
+    case CT_FRACTAL :
+      if (bFastFractal) params.iFastLanes = MandelbulbLaneCount();
+      return LargeRAWFile_ptr(new ProceduralRAWFile<T, CT_FRACTAL>(
+                                strName, vSize, params));
+    case CT_SPHERE :
+      return LargeRAWFile_ptr(new ProceduralRAWFile<T, CT_SPHERE>(
+                                strName, vSize, params));
+    case CT_CONST_VALUE :
+      params.iIterations = 0;
+      return LargeRAWFile_ptr(new ProceduralRAWFile<T, CT_CONST_VALUE>(
+                                strName, vSize, params));
+    case CT_RANDOM :
+      return LargeRAWFile_ptr(new ProceduralRAWFile<T, CT_RANDOM>(
+                                strName, vSize, params));
+    case CT_NOISE :
+      return LargeRAWFile_ptr(new ProceduralRAWFile<T, CT_NOISE>(
+                                strName, vSize, params));
+    case CT_PHANTOM :
+      return LargeRAWFile_ptr(new ProceduralRAWFile<T, CT_PHANTOM>(
+                                strName, vSize, params));
+    case CT_BLOBS :
+      return LargeRAWFile_ptr(new ProceduralRAWFile<T, CT_BLOBS>(
+                                strName, vSize, params));
+    case CT_GRADIENT :
+      return LargeRAWFile_ptr(new ProceduralRAWFile<T, CT_GRADIENT>(
+                                strName, vSize, params));
+  }
+  return LargeRAWFile_ptr();
+}
+
+// component type of the bricked volume, false if the bricker has none
+bool GetComponentType(uint32_t iBitSize, bool bFloat,
+                      ExtendedOctree::COMPONENT_TYPE& eType) {
+  switch (iBitSize) {
+    case 8 :  eType = ExtendedOctree::CT_UINT8; return !bFloat;
+    case 16 : eType = ExtendedOctree::CT_UINT16; return !bFloat;
+    case 32 : eType = bFloat ? ExtendedOctree::CT_FLOAT32
+                             : ExtendedOctree::CT_UINT32; return true;
+    case 64 : eType = ExtendedOctree::CT_FLOAT64; return bFloat;
+  }
+  return false;
+}
+
+// Histograms, value statistics and brick checksums of a volume that was
+// just bricked into strTempFile, computed in one parallel pass so every
+// brick is read and decompressed once. Histograms and statistics cover the
+// finest LoD, the checksums all bricks; a NULL target skips its part. T is
+// the voxel type of the histograms, an unsigned 8 or 16 bit type.
+template<typename T>
+bool AnalyzeBrickedVolume(const TOCBlock* toc, const std::string& strTempFile,
+                          uint64_t iMaxValue, unsigned int iWorkers,
+                          Histogram1DDataBlock* histogram1D,
+                          Histogram2DDataBlock* histogram2D,
+                          std::vector<ValueStatistics>* vStatistics,
+                          std::shared_ptr<KeyValuePairDataBlock>* checksums,
+                          std::string& strProblem) {
+  const bool bHistograms = histogram1D && histogram2D;
+  if (bHistograms && (toc->GetComponentCount() != 1 ||
+                      toc->GetComponentTypeSize() != sizeof(T))) {
+    strProblem = "only scalar volumes of the histogram type are supported";
+    return false;
   }
+  const std::vector<UINT64VECTOR4> vBricks = checksums
+                                             ? EnumerateBricks(toc)
+                                             : LoDBricks(toc, 0);
+  iWorkers = std::max(1u, iWorkers);
+
+  std::unique_ptr<BrickHistograms<T>> histograms;
+  if (bHistograms)
+    histograms.reset(new BrickHistograms<T>(iMaxValue, 4096, iWorkers));
+  const ExtendedOctree::COMPONENT_TYPE eType = toc->GetComponentType();
+  const size_t iComponents = size_t(toc->GetComponentCount());
+  std::vector<std::vector<ValueAccumulator>> vAcc;
+  if (vStatistics)
+    vAcc.assign(iWorkers, std::vector<ValueAccumulator>(
+                            iComponents, ValueAccumulator(eType)));
+  // every brick belongs to exactly one worker, so no locking is needed
+  std::vector<std::string> vChecksums(checksums ? vBricks.size() : 0);
+
+  if (!ForEachBrickedBrick(toc, strTempFile, vBricks, iWorkers,
+        [&](unsigned int t, size_t i, const TOCBlock*,
+            const std::vector<uint8_t>& data) {
+          if (checksums) vChecksums[i] = BrickChecksum(data);
+          if (vBricks[i].w != 0) return;
+          if (histograms) histograms->AddBrick(t, toc, vBricks[i], data);
+          if (vStatistics) AccumulateBrick(toc, vBricks[i], data, vAcc[t]);
+        }, strProblem))
+    return false;
+
+  if (histograms) histograms->Store(*histogram1D, *histogram2D);
+  if (vStatistics) *vStatistics = MergeStatistics(eType, iComponents, vAcc);
+  if (checksums) *checksums = CreateBrickChecksumBlock(vBricks, vChecksums);
+  return true;
 }
 
 bool CreateUVFFile(const std::string& strUVFName, const UINT64VECTOR3& vSize,
-                   uint32_t iBitSize, ECreationType eCreationType, uint32_t iIterations,
+                   uint32_t iBitSize, bool bFloat, ECreationType eCreationType,
+                   const GeneratorParams& params,
                    bool bUseToCBlock, bool bKeepRaw, uint32_t iCompression,
                    uint32_t iUVFMemory, uint32_t iBrickSize, uint32_t iLayout,
-                   uint32_t iCompressionLevel, bool bHierarchical) {
+                   uint32_t iCompressionLevel, bool bHierarchical,
+                   bool bFastFractal, bool bDirectToBrick,
+                   bool bBrickChecksums, bool bStatistics) {
   wstring wstrUVFName(strUVFName.begin(), strUVFName.end());
   UVF uvfFile(wstrUVFName);
 
@@ -408,42 +1002,114 @@ bool CreateUVFFile(const std::string& strUVFName, const UINT64VECTOR3& vSize,
   std::string rawFilename =
         bGenerateUVF ? SysTools::ChangeExt(strUVFName,"raw") : strUVFName;
 
-  MESSAGE("Generating dummy data");
-
-  LargeRAWFile_ptr dummyData = LargeRAWFile_ptr(new LargeRAWFile(rawFilename));
-  if (!dummyData->Create(vSize.volume()*iBitSize/8)) {
-    T_ERROR("Failed to create %s file.", rawFilename.c_str());
+  ExtendedOctree::COMPONENT_TYPE eComponentType;
+  const bool bBrickable = GetComponentType(iBitSize, bFloat, eComponentType);
+  if (bGenerateUVF && !bBrickable) {
+    T_ERROR("%u bit %s data cannot be stored in a UVF file, "
+            "create a raw file instead.", iBitSize,
+            bFloat ? "float" : "integer");
     return false;
   }
 
-  Timer generationTimer;
-  generationTimer.Start();
-  switch (iBitSize) {
-    case 8 :
-      switch (eCreationType) {
-        case CT_FRACTAL : MESSAGE("Generating a fractal"); GenerateVolumeData<uint8_t, CT_FRACTAL>(vSize, dummyData, iIterations, bHierarchical); break;
-        case CT_SPHERE : MESSAGE("Generating a sphere"); GenerateVolumeData<uint8_t, CT_SPHERE>(vSize, dummyData, iIterations, bHierarchical); break;
-        case CT_CONST_VALUE : MESSAGE("Generating zeroes"); GenerateVolumeData<uint8_t, CT_CONST_VALUE>(vSize, dummyData, 0, bHierarchical); break;
-        case CT_RANDOM : MESSAGE("Generating noise"); GenerateVolumeData<uint8_t, CT_RANDOM>(vSize, dummyData, iIterations, bHierarchical); break;
-      }
-      break;
-    case 16 :
-      switch (eCreationType) {
-        case CT_FRACTAL : MESSAGE("Generating a fractal"); GenerateVolumeData<uint16_t, CT_FRACTAL>(vSize, dummyData, iIterations, bHierarchical); break;
-        case CT_SPHERE : MESSAGE("Generating a sphere"); GenerateVolumeData<uint16_t, CT_SPHERE>(vSize, dummyData, iIterations, bHierarchical); break;
-        case CT_CONST_VALUE : MESSAGE("Generating zeroes"); GenerateVolumeData<uint16_t, CT_CONST_VALUE>(vSize, dummyData, 0, bHierarchical); break;
-        case CT_RANDOM : MESSAGE("Generating noise"); GenerateVolumeData<uint16_t, CT_RANDOM>(vSize, dummyData, iIterations, bHierarchical); break;
-      }
-      break;
-    default:
-      T_ERROR("Invalid bitsize");
+  LargeRAWFile_ptr dummyData;
+  uint64_t genMiliSecs = 0;
+
+  if (bDirectToBrick) {
+    if (!bGenerateUVF || !bUseToCBlock) {
+      T_ERROR("Direct brick generation requires a UVF target "
+              "with a TOC block.");
       return false;
-  }
-  dummyData->Close();
+    }
+    MESSAGE("Generating bricks directly from the procedural data source");
+    switch (iBitSize) {
+      case 8 :
+        dummyData = CreateProceduralSource<uint8_t>(rawFilename, eCreationType,
+                                                    vSize, params,
+                                                    bFastFractal);
+        break;
+      case 16 :
+        dummyData = CreateProceduralSource<uint16_t>(rawFilename, eCreationType,
+                                                     vSize, params,
+                                                     bFastFractal);
+        break;
+      case 32 :
+        if (bFloat)
+          dummyData = CreateProceduralSource<float>(rawFilename, eCreationType,
+                                                    vSize, params,
+                                                    bFastFractal);
+        else
+          dummyData = CreateProceduralSource<uint32_t>(rawFilename,
+                                                       eCreationType, vSize,
+                                                       params, bFastFractal);
+        break;
+      case 64 :
+        dummyData = CreateProceduralSource<double>(rawFilename, eCreationType,
+                                                   vSize, params,
+                                                   bFastFractal);
+        break;
+      default:
+        T_ERROR("Invalid bitsize");
+        return false;
+    }
+  } else {
+    MESSAGE("Generating dummy data");
+
+    dummyData = LargeRAWFile_ptr(new LargeRAWFile(rawFilename));
+    if (!dummyData->Create(vSize.volume()*iBitSize/8)) {
+      T_ERROR("Failed to create %s file.", rawFilename.c_str());
+      return false;
+    }
+
+    Timer generationTimer;
+    generationTimer.Start();
+    bool bGenerated = false;
+    switch (iBitSize) {
+      case 8 :
+        bGenerated = GenerateVolume<uint8_t>(eCreationType, vSize, dummyData,
+                                             params, bHierarchical,
+                                             bFastFractal);
+        break;
+      case 16 :
+        if (bFloat)
+          bGenerated = GenerateVolume<HalfFloat>(eCreationType, vSize,
+                                                 dummyData, params,
+                                                 bHierarchical, bFastFractal);
+        else
+          bGenerated = GenerateVolume<uint16_t>(eCreationType, vSize,
+                                                dummyData, params,
+                                                bHierarchical, bFastFractal);
+        break;
+      case 32 :
+        if (bFloat)
+          bGenerated = GenerateVolume<float>(eCreationType, vSize, dummyData,
+                                             params, bHierarchical,
+                                             bFastFractal);
+        else
+          bGenerated = GenerateVolume<uint32_t>(eCreationType, vSize,
+                                                dummyData, params,
+                                                bHierarchical, bFastFractal);
+        break;
+      case 64 :
+        bGenerated = GenerateVolume<double>(eCreationType, vSize, dummyData,
+                                            params, bHierarchical,
+                                            bFastFractal);
+        break;
+      default:
+        T_ERROR("Invalid bitsize");
+        return false;
+    }
+    dummyData->Close();
 
-  uint64_t genMiliSecs = uint64_t(generationTimer.Elapsed());
+    if (!bGenerated) {
+      T_ERROR("Failed to generate the volume data.");
+      dummyData->Delete();
+      return false;
+    }
 
-  if (!bGenerateUVF) return EXIT_FAILURE;
+    genMiliSecs = uint64_t(generationTimer.Elapsed());
+
+    if (!bGenerateUVF) return EXIT_FAILURE;
+  }
 
   Timer uvfTimer;
   uvfTimer.Start();
@@ -471,15 +1137,16 @@ bool CreateUVFFile(const std::string& strUVFName, const UINT64VECTOR3& vSize,
     new RasterDataBlock()
   );
   std::shared_ptr<TOCBlock> tocBlock(new TOCBlock(UVF::ms_ulReaderVersion));
+  const std::string strTOCTempFile = "./tempFile.tmp";
 
   if (bUseToCBlock)  {
     MESSAGE("Buidling hirarchy ...");
     tocBlock->strBlockID = "Test TOC Volume 1";
     tocBlock->ulCompressionScheme = UVFTables::COS_NONE;
 
-    bool bResult = tocBlock->FlatDataToBrickedLOD(rawFilename,
-      "./tempFile.tmp", iBitSize == 8 ? ExtendedOctree::CT_UINT8
-                                      : ExtendedOctree::CT_UINT16,
+    dummyData->Open();
+    bool bResult = tocBlock->FlatDataToBrickedLOD(dummyData,
+      strTOCTempFile, eComponentType,
       1, vSize, DOUBLEVECTOR3(1,1,1),
       UINT64VECTOR3(iBrickSize,iBrickSize,iBrickSize),
       DEFAULT_BRICKOVERLAP, false, false,
@@ -528,7 +1195,10 @@ bool CreateUVFFile(const std::string& strUVFName, const UINT64VECTOR3& vSize,
 
     testRasterVolume->ulLODLevelCount.push_back(iLodLevelCount);
 
-    testRasterVolume->SetTypeToScalar(iBitSize,iBitSize,false,UVFTables::ES_CT);
+    testRasterVolume->SetTypeToScalar(iBitSize,
+                                      bFloat ? (iBitSize == 32 ? 23 : 52)
+                                             : iBitSize,
+                                      bFloat, UVFTables::ES_CT);
 
     testRasterVolume->ulBrickSize.push_back(iBrickSize);
     testRasterVolume->ulBrickSize.push_back(iBrickSize);
@@ -570,6 +1240,38 @@ bool CreateUVFFile(const std::string& strUVFName, const UINT64VECTOR3& vSize,
                 }
                 break;
               }
+    case 32 :{
+                bool bBricked;
+                if (bFloat)
+                  bBricked = testRasterVolume->FlatDataToBrickedLOD(dummyData,
+                    "./tempFile.tmp", CombineAverage<float,1>,
+                    SimpleMaxMin<float,1>, MaxMinData,
+                    &tuvok::Controller::Debug::Out());
+                else
+                  bBricked = testRasterVolume->FlatDataToBrickedLOD(dummyData,
+                    "./tempFile.tmp", CombineAverage<uint32_t,1>,
+                    SimpleMaxMin<uint32_t,1>, MaxMinData,
+                    &tuvok::Controller::Debug::Out());
+                if (!bBricked) {
+                  T_ERROR("Failed to subdivide the volume into bricks");
+                  uvfFile.Close();
+                  dummyData->Delete();
+                  return false;
+                }
+                break;
+              }
+    case 64 :{
+                if (!testRasterVolume->FlatDataToBrickedLOD(dummyData,
+                  "./tempFile.tmp", CombineAverage<double,1>,
+                  SimpleMaxMin<double,1>, MaxMinData,
+                  &tuvok::Controller::Debug::Out())){
+                  T_ERROR("Failed to subdivide the volume into bricks");
+                  uvfFile.Close();
+                  dummyData->Delete();
+                  return false;
+                }
+                break;
+              }
     }
 
     string strProblemDesc;
@@ -598,23 +1300,42 @@ bool CreateUVFFile(const std::string& strUVFName, const UINT64VECTOR3& vSize,
   std::shared_ptr<Histogram2DDataBlock> Histogram2D(
     new Histogram2DDataBlock()
   );
-  if (bUseToCBlock) {
-    MESSAGE("Computing 1D Histogram...");
-    if (!Histogram1D->Compute(tocBlock.get(), 0)) {
-      T_ERROR("Computation of 1D Histogram failed!");
-      uvfFile.Close();
-      return false;
-    }
-    Histogram1D->Compress(4096);
-    MESSAGE("Computing 2D Histogram...");
-    if (!Histogram2D->Compute(tocBlock.get(), 0,
-                              Histogram1D->GetHistogram().size(),
-                              MaxMinData->GetGlobalValue().maxScalar)) {
-      T_ERROR("Computation of 2D Histogram failed!");
+  // the histogram blocks have one bin per integer value, which is
+  // meaningless for floats and far too large for 32 bit integers
+  const bool bHistograms = !bFloat && iBitSize <= 16;
+  if (!bHistograms) {
+    MESSAGE("Skipping the histograms for %u bit %s data", iBitSize,
+            bFloat ? "float" : "integer");
+  }
+
+  std::vector<ValueStatistics> vStatistics;
+  std::shared_ptr<KeyValuePairDataBlock> checksums;
+  if (bUseToCBlock && (bHistograms || bBrickChecksums || bStatistics)) {
+    // histograms, brick checksums and statistics in one parallel pass
+    MESSAGE("Analyzing the bricks...");
+    const uint64_t iMaxValue =
+      uint64_t(std::max(0.0, MaxMinData->GetGlobalValue().maxScalar));
+    std::string strProblem;
+    const bool bComputed = (iBitSize == 16)
+      ? AnalyzeBrickedVolume<uint16_t>(
+          tocBlock.get(), strTOCTempFile, iMaxValue, WorkerCount(),
+          bHistograms ? Histogram1D.get() : NULL,
+          bHistograms ? Histogram2D.get() : NULL,
+          bStatistics ? &vStatistics : NULL,
+          bBrickChecksums ? &checksums : NULL, strProblem)
+      : AnalyzeBrickedVolume<uint8_t>(
+          tocBlock.get(), strTOCTempFile, iMaxValue, WorkerCount(),
+          bHistograms ? Histogram1D.get() : NULL,
+          bHistograms ? Histogram2D.get() : NULL,
+          bStatistics ? &vStatistics : NULL,
+          bBrickChecksums ? &checksums : NULL, strProblem);
+    if (!bComputed) {
+      T_ERROR("Analysis of the bricks failed: %s", strProblem.c_str());
       uvfFile.Close();
       return false;
     }
-  } else {
+    if (bHistograms) Histogram1D->Compress(4096);
+  } else if (bHistograms) {
     if (!Histogram1D->Compute(testRasterVolume.get())) {
       T_ERROR("Computation of 1D Histogram failed!");
       uvfFile.Close();
@@ -631,13 +1352,25 @@ bool CreateUVFFile(const std::string& strUVFName, const UINT64VECTOR3& vSize,
     }
   }
 
-  MESSAGE("Storing histogram data...");
-  uvfFile.AddDataBlock(Histogram1D);
-  uvfFile.AddDataBlock(Histogram2D);
+  if (bHistograms) {
+    MESSAGE("Storing histogram data...");
+    uvfFile.AddDataBlock(Histogram1D);
+    uvfFile.AddDataBlock(Histogram2D);
+  }
 
   MESSAGE("Storing acceleration data...");
   uvfFile.AddDataBlock(MaxMinData);
 
+  if (checksums) {
+    MESSAGE("Storing brick checksums...");
+    uvfFile.AddDataBlock(checksums);
+  }
+
+  if (bUseToCBlock && bStatistics) {
+    MESSAGE("Storing value statistics...");
+    uvfFile.AddDataBlock(StatisticsToKVP(vStatistics));
+  }
+
   MESSAGE("Storing metadata...");
 
   std::shared_ptr<KeyValuePairDataBlock> metaPairs(
@@ -651,7 +1384,7 @@ bool CreateUVFFile(const std::string& strUVFName, const UINT64VECTOR3& vSize,
   else
     metaPairs->AddPair("Source Endianess","big");
 
-  metaPairs->AddPair("Source Type","integer");
+  metaPairs->AddPair("Source Type", bFloat ? "float" : "integer");
   metaPairs->AddPair("Source Bit width",SysTools::ToString(iBitSize));
 
   uvfFile.AddDataBlock(metaPairs);
@@ -675,10 +1408,15 @@ bool CreateUVFFile(const std::string& strUVFName, const UINT64VECTOR3& vSize,
   const uint64_t genMins  = (genMiliSecs/60000)%60;
   const uint64_t genHours = (genMiliSecs/3600000);
 
-  MESSAGE("Successfully created UVF file %s (generator time: %i:%02i:%02i  "
-                                            "UVF time: %i:%02i:%02i)",
-          strUVFName.c_str(), int(genHours), int(genMins), int(genSecs),
-          int(uvfHours), int(uvfMins), int(uvfSecs));
+  if (bDirectToBrick)
+    MESSAGE("Successfully created UVF file %s (generator and UVF time: "
+                                              "%i:%02i:%02i)",
+            strUVFName.c_str(), int(uvfHours), int(uvfMins), int(uvfSecs));
+  else
+    MESSAGE("Successfully created UVF file %s (generator time: %i:%02i:%02i  "
+                                              "UVF time: %i:%02i:%02i)",
+            strUVFName.c_str(), int(genHours), int(genMins), int(genSecs),
+            int(uvfHours), int(uvfMins), int(uvfSecs));
   return true;
 }
 
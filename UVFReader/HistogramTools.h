@@ -0,0 +1,277 @@
+#ifndef HISTOGRAMTOOLS_H
+#define HISTOGRAMTOOLS_H
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <cstdint>
+
+#include "../Tuvok/StdTuvokDefines.h"
+#include "../Tuvok/Basics/Vectors.h"
+#include "../Tuvok/IO/UVF/TOCBlock.h"
+#include "../Tuvok/IO/UVF/Histogram1DDataBlock.h"
+#include "../Tuvok/IO/UVF/Histogram2DDataBlock.h"
+
+#include "BrickTools.h"
+
+// Bins of the gradient axis of the 2D histogram.
+static const size_t HISTOGRAM_GRADIENT_BINS = 256;
+
+// Bins of the gradient axis while accumulating, twice the final count so
+// the final bins are never narrower than the accumulated ones.
+static const size_t ACCUMULATOR_GRADIENT_BINS = 2 * HISTOGRAM_GRADIENT_BINS;
+
+// Per thread 1D and 2D histogram of one integer volume. The gradient axis
+// covers [0, 2^iGradientExponent); when a larger gradient shows up the
+// range doubles and neighbouring bins merge. Ranges are powers of two, so
+// threads that ended with different ranges can be merged exactly. The
+// merged result is rebinned to [0, max gradient] once at the end, as the
+// histograms Tuvok computes.
+class HistogramAccumulator {
+public:
+  HistogramAccumulator(size_t iValueCount, size_t iValueBins) :
+    m_v1D(iValueCount, 0),
+    m_v2D(iValueBins * ACCUMULATOR_GRADIENT_BINS, 0),
+    m_iValueBins(iValueBins),
+    m_iGradientExponent(0),
+    m_fGradientScale(ACCUMULATOR_GRADIENT_BINS),
+    m_fMaxGradient(0.0f)
+  {}
+
+  // iVoxels voxels of one row; pNeighbours are the rows before and after
+  // in y and z, pRow[-1] and pRow[iVoxels] must be valid
+  template<typename T>
+  void AddRow(const T* pRow, const T* pPrevY, const T* pNextY,
+              const T* pPrevZ, const T* pNextZ, size_t iVoxels,
+              double fValueToBin) {
+    for (size_t x = 0;x<iVoxels;x++) {
+      const T v = pRow[x];
+      m_v1D[size_t(v)]++;
+
+      const float gx = (float(pRow[x+1]) - float(pRow[x-1])) * 0.5f;
+      const float gy = (float(pNextY[x]) - float(pPrevY[x])) * 0.5f;
+      const float gz = (float(pNextZ[x]) - float(pPrevZ[x])) * 0.5f;
+      const float fGradient = sqrt(gx*gx + gy*gy + gz*gz);
+      m_fMaxGradient = std::max(m_fMaxGradient, fGradient);
+      while (fGradient * m_fGradientScale >= ACCUMULATOR_GRADIENT_BINS)
+        DoubleGradientRange();
+
+      const size_t iValueBin = std::min(size_t(double(v) * fValueToBin),
+                                        m_iValueBins-1);
+      const size_t iGradientBin = size_t(fGradient * m_fGradientScale);
+      m_v2D[iValueBin * ACCUMULATOR_GRADIENT_BINS + iGradientBin]++;
+    }
+  }
+
+  void Merge(HistogramAccumulator& other) {
+    while (m_iGradientExponent < other.m_iGradientExponent)
+      DoubleGradientRange();
+    while (other.m_iGradientExponent < m_iGradientExponent)
+      other.DoubleGradientRange();
+    for (size_t i = 0;i<m_v1D.size();i++) m_v1D[i] += other.m_v1D[i];
+    for (size_t i = 0;i<m_v2D.size();i++) m_v2D[i] += other.m_v2D[i];
+    m_fMaxGradient = std::max(m_fMaxGradient, other.m_fMaxGradient);
+  }
+
+  // without the empty bins above the largest value
+  std::vector<uint64_t> Histogram1D() const {
+    size_t iSize = m_v1D.size();
+    while (iSize > 1 && m_v1D[iSize-1] == 0) iSize--;
+    return std::vector<uint64_t>(m_v1D.begin(), m_v1D.begin() + iSize);
+  }
+
+  // HISTOGRAM_GRADIENT_BINS gradient bins over [0, MaxGradient()]. Every
+  // accumulated bin is split between the final bins it overlaps in
+  // proportion to the overlap, the counts per value bin stay exact.
+  std::vector<std::vector<uint64_t>> Histogram2D() const {
+    std::vector<std::vector<uint64_t>> vHist(m_iValueBins,
+      std::vector<uint64_t>(HISTOGRAM_GRADIENT_BINS, 0));
+    // width of an accumulated bin in final bins
+    const double fWidth = m_fMaxGradient > 0.0f
+      ? double(HISTOGRAM_GRADIENT_BINS) / (m_fGradientScale * m_fMaxGradient)
+      : 0.0;
+    for (size_t v = 0;v<m_iValueBins;v++) {
+      const uint64_t* p = &m_v2D[v * ACCUMULATOR_GRADIENT_BINS];
+      for (size_t g = 0;g<ACCUMULATOR_GRADIENT_BINS;g++) {
+        if (p[g] == 0) continue;
+        const double fStart = g * fWidth;
+        const double fEnd = fStart + fWidth;
+        uint64_t iAssigned = 0;
+        for (size_t o = std::min(size_t(fStart), HISTOGRAM_GRADIENT_BINS-1);
+             iAssigned < p[g] && o<HISTOGRAM_GRADIENT_BINS;o++) {
+          const double fCovered = fWidth > 0.0
+            ? (std::min(fEnd, double(o+1)) - fStart) / fWidth : 1.0;
+          const uint64_t iUpTo = (o+1 == HISTOGRAM_GRADIENT_BINS)
+            ? p[g]
+            : std::min(p[g], uint64_t(double(p[g]) * fCovered + 0.5));
+          vHist[v][o] += iUpTo - iAssigned;
+          iAssigned = iUpTo;
+        }
+      }
+    }
+    return vHist;
+  }
+
+  float MaxGradient() const { return m_fMaxGradient; }
+
+private:
+  std::vector<uint64_t> m_v1D;
+  std::vector<uint64_t> m_v2D;
+  size_t m_iValueBins;
+  int    m_iGradientExponent;
+  float  m_fGradientScale;  // gradient to bin index
+  float  m_fMaxGradient;
+
+  void DoubleGradientRange() {
+    for (size_t v = 0;v<m_iValueBins;v++) {
+      uint64_t* p = &m_v2D[v * ACCUMULATOR_GRADIENT_BINS];
+      for (size_t g = 0;g<ACCUMULATOR_GRADIENT_BINS/2;g++)
+        p[g] = p[2*g] + p[2*g+1];
+      std::fill(p + ACCUMULATOR_GRADIENT_BINS/2,
+                p + ACCUMULATOR_GRADIENT_BINS, uint64_t(0));
+    }
+    m_iGradientExponent++;
+    m_fGradientScale *= 0.5f;
+  }
+};
+
+// Adds the interior of one brick, the overlap only serves as neighbours
+// for the gradients (with no overlap the brick border is clamped).
+template<typename T>
+void AccumulateHistogramBrick(const TOCBlock* toc, const UINT64VECTOR4& key,
+                              const std::vector<uint8_t>& data,
+                              double fValueToBin,
+                              HistogramAccumulator& acc) {
+  const UINT64VECTOR3 vSize = toc->GetBrickSize(key);
+  const uint64_t iOverlap = toc->GetOverlap();
+  const T* p = reinterpret_cast<const T*>(data.data());
+  const size_t iRowVoxels = size_t(vSize.x - 2*iOverlap);
+  std::vector<T> vRow(iRowVoxels + 2);
+
+  for (uint64_t z = iOverlap;z<vSize.z - iOverlap;z++) {
+    const uint64_t zm = z > 0 ? z-1 : z;
+    const uint64_t zp = z+1 < vSize.z ? z+1 : z;
+    for (uint64_t y = iOverlap;y<vSize.y - iOverlap;y++) {
+      const uint64_t ym = y > 0 ? y-1 : y;
+      const uint64_t yp = y+1 < vSize.y ? y+1 : y;
+      const size_t iStart = size_t((z * vSize.y + y) * vSize.x + iOverlap);
+      const T* pRow = p + iStart;
+      if (iOverlap == 0) {
+        // pad the row so pRow[-1] and pRow[iRowVoxels] exist
+        std::copy(pRow, pRow + iRowVoxels, vRow.begin() + 1);
+        vRow.front() = vRow[1];
+        vRow.back() = vRow[iRowVoxels];
+        pRow = vRow.data() + 1;
+      }
+      acc.AddRow(pRow,
+                 p + size_t((z * vSize.y + ym) * vSize.x + iOverlap),
+                 p + size_t((z * vSize.y + yp) * vSize.x + iOverlap),
+                 p + size_t((zm * vSize.y + y) * vSize.x + iOverlap),
+                 p + size_t((zp * vSize.y + y) * vSize.x + iOverlap),
+                 iRowVoxels, fValueToBin);
+    }
+  }
+}
+
+// The 1D and the 2D value/gradient histogram of an unsigned 8 or 16 bit
+// integer volume, filled brick by brick from several threads: every
+// thread adds to its own histograms and they are merged at the end. The
+// 1D histogram has one bin per value up to the largest one, the 2D
+// histogram min(iMaxValue+1, iMaxValueBins) value bins, where iMaxValue
+// comes from the max-min data of the bricking.
+template<typename T>
+class BrickHistograms {
+public:
+  BrickHistograms(uint64_t iMaxValue, size_t iMaxValueBins,
+                  unsigned int iWorkers) {
+    const size_t iValueCount = size_t(std::numeric_limits<T>::max()) + 1;
+    iMaxValue = std::min<uint64_t>(iMaxValue, iValueCount-1);
+    const size_t iValueBins = std::min(size_t(iMaxValue) + 1,
+                                       iMaxValueBins);
+    m_fValueToBin = iMaxValue > 0 ? double(iValueBins-1) / double(iMaxValue)
+                                  : 0.0;
+    for (unsigned int t = 0;t<std::max(1u, iWorkers);t++)
+      m_vWorker.push_back(std::unique_ptr<HistogramAccumulator>(
+        new HistogramAccumulator(iValueCount, iValueBins)));
+  }
+
+  void AddBrick(unsigned int iWorker, const TOCBlock* toc,
+                const UINT64VECTOR4& key, const std::vector<uint8_t>& data) {
+    AccumulateHistogramBrick<T>(toc, key, data, m_fValueToBin,
+                                *m_vWorker[iWorker]);
+  }
+
+  void Store(Histogram1DDataBlock& histogram1D,
+             Histogram2DDataBlock& histogram2D) {
+    for (size_t t = 1;t<m_vWorker.size();t++)
+      m_vWorker[0]->Merge(*m_vWorker[t]);
+    std::vector<uint64_t> v1D = m_vWorker[0]->Histogram1D();
+    histogram1D.SetHistogram(v1D);
+    std::vector<std::vector<uint64_t>> v2D = m_vWorker[0]->Histogram2D();
+    histogram2D.SetHistogram(v2D, m_vWorker[0]->MaxGradient());
+  }
+
+private:
+  double m_fValueToBin;
+  std::vector<std::unique_ptr<HistogramAccumulator>> m_vWorker;
+};
+
+// Computes both histograms of the finest LoD of a TOC block that was just
+// bricked into strTempFile in one parallel pass, every brick is read once.
+// T must be an unsigned 8 or 16 bit type matching the volume.
+template<typename T>
+bool ComputeHistograms(const TOCBlock* toc, const std::string& strTempFile,
+                       uint64_t iMaxValue, size_t iMaxValueBins,
+                       unsigned int iWorkers,
+                       Histogram1DDataBlock& histogram1D,
+                       Histogram2DDataBlock& histogram2D,
+                       std::string& strProblem) {
+  if (toc->GetComponentCount() != 1 ||
+      toc->GetComponentTypeSize() != sizeof(T)) {
+    strProblem = "only scalar volumes of the histogram type are supported";
+    return false;
+  }
+
+  const std::vector<UINT64VECTOR4> vBricks = LoDBricks(toc, 0);
+  iWorkers = std::max(1u, iWorkers);
+  BrickHistograms<T> histograms(iMaxValue, iMaxValueBins, iWorkers);
+  if (!ForEachBrickedBrick(toc, strTempFile, vBricks, iWorkers,
+        [&](unsigned int t, size_t i, const TOCBlock*,
+            const std::vector<uint8_t>& data) {
+          histograms.AddBrick(t, toc, vBricks[i], data);
+        }, strProblem))
+    return false;
+  histograms.Store(histogram1D, histogram2D);
+  return true;
+}
+
+#endif // HISTOGRAMTOOLS_H
+
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2012 Interactive Visualization and Data Analysis Group
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
@@ -0,0 +1,196 @@
+#ifndef MANDELBULBKERNEL_H
+#define MANDELBULBKERNEL_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+// Lane-parallel evaluation of the power 8 mandelbulb without any calls to
+// atan2, sin, cos or pow. With rho = sqrt(x^2+y^2) the spherical power
+// formula used by ComputeMandelbulb turns into two complex powers:
+//
+//   r^8 cos(8 theta)            = Re((z + i rho)^8)
+//   r^8 sin(8 theta)            = Im((z + i rho)^8)
+//   cos(8 phi) + i sin(8 phi)   = (x + i y)^8 / rho^8
+//
+// so each iteration costs three complex squarings per term, one sqrt and
+// one division. The lanes are plain arrays processed with branch free
+// loops, escaped lanes are masked out and keep their value, and the batch
+// stops as soon as every lane has escaped.
+//
+// The result is mathematically identical to ComputeMandelbulb<T>(..., 8,
+// ...) but rounds differently, so points close to the boundary of the set
+// can escape one or more iterations earlier or later. It is therefore only
+// used when explicitly requested; the reference kernel stays the default so
+// previously generated datasets can be reproduced.
+
+#if defined(__GNUC__)
+  #define MANDELBULB_FORCEINLINE inline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+  #define MANDELBULB_FORCEINLINE __forceinline
+#else
+  #define MANDELBULB_FORCEINLINE inline
+#endif
+
+template<typename T, size_t N>
+MANDELBULB_FORCEINLINE
+void ComputeMandelbulb8Lanes(const double* sx, const double* sy,
+                             const double* sz, const T iMaxIterations,
+                             const double fBailout, T* result) {
+#ifdef __clang__
+  // clang contracts by default and ignores the optimize attribute below
+  #pragma clang fp contract(off)
+#endif
+  double fx[N], fy[N], fz[N], active[N];
+  for (size_t l = 0;l<N;++l) {
+    fx[l] = fy[l] = fz[l] = 0.0;
+    active[l] = 1.0;
+    result[l] = iMaxIterations;
+  }
+  const double fBailout2 = fBailout*fBailout;
+
+  for (T i = 0; i <= iMaxIterations; i++) {
+    double remaining = 0.0;
+    for (size_t l = 0;l<N;++l) {
+      const double x = fx[l], y = fy[l], z = fz[l];
+      const double rho2 = x*x + y*y;
+      const double rho  = std::sqrt(rho2);
+
+      // (x + i y)^8
+      double br = x*x - y*y,   bi = 2.0*x*y;
+      double tr = br*br - bi*bi; bi = 2.0*br*bi; br = tr;
+      tr = br*br - bi*bi;        bi = 2.0*br*bi; br = tr;
+
+      // (z + i rho)^8
+      double ar = z*z - rho2,  ai = 2.0*z*rho;
+      tr = ar*ar - ai*ai;        ai = 2.0*ar*ai; ar = tr;
+      tr = ar*ar - ai*ai;        ai = 2.0*ar*ai; ar = tr;
+
+      const double rho4 = rho2*rho2;
+      const double rho8 = rho4*rho4;
+      const double scale = rho8 > 0.0 ? ai/rho8 : 0.0;
+
+      const double nx = sx[l] + scale*br;
+      const double ny = sy[l] + scale*bi;
+      const double nz = sz[l] + ar;
+
+      const bool bActive = active[l] != 0.0;
+      fx[l] = bActive ? nx : x;
+      fy[l] = bActive ? ny : y;
+      fz[l] = bActive ? nz : z;
+
+      const bool bEscaped = bActive && (nx*nx + ny*ny + nz*nz) > fBailout2;
+      result[l] = bEscaped ? i : result[l];
+      active[l] = bEscaped ? 0.0 : active[l];
+      remaining += active[l];
+    }
+    if (remaining == 0.0) break;
+  }
+}
+
+// Instruction set specific entry points. Only GCC/clang on x86 allow us to
+// compile single functions for a wider instruction set than the rest of the
+// binary; everywhere else all widths use the baseline code path. AVX2 and
+// AVX-512 bring FMA instructions along, so contraction is switched off (for
+// clang inside ComputeMandelbulb8Lanes) to keep the results of all paths
+// identical.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  #define MANDELBULB_MULTIVERSION 1
+  #define MANDELBULB_TARGET(isa) __attribute__((target(isa)))
+#else
+  #define MANDELBULB_TARGET(isa)
+#endif
+
+#if defined(__GNUC__) && !defined(__clang__)
+  #define MANDELBULB_NOCONTRACT __attribute__((optimize("fp-contract=off")))
+#else
+  #define MANDELBULB_NOCONTRACT
+#endif
+
+template<typename T>
+MANDELBULB_TARGET("avx512f") MANDELBULB_NOCONTRACT
+void ComputeMandelbulb8x16(const double* sx, const double* sy,
+                           const double* sz, const T iMaxIterations,
+                           const double fBailout, T* result) {
+  ComputeMandelbulb8Lanes<T,16>(sx, sy, sz, iMaxIterations, fBailout, result);
+}
+
+template<typename T>
+MANDELBULB_TARGET("avx2") MANDELBULB_NOCONTRACT
+void ComputeMandelbulb8x8(const double* sx, const double* sy,
+                          const double* sz, const T iMaxIterations,
+                          const double fBailout, T* result) {
+  ComputeMandelbulb8Lanes<T,8>(sx, sy, sz, iMaxIterations, fBailout, result);
+}
+
+template<typename T>
+MANDELBULB_NOCONTRACT
+void ComputeMandelbulb8x4(const double* sx, const double* sy,
+                          const double* sz, const T iMaxIterations,
+                          const double fBailout, T* result) {
+  ComputeMandelbulb8Lanes<T,4>(sx, sy, sz, iMaxIterations, fBailout, result);
+}
+
+// returns how many lanes the widest kernel supported by this CPU evaluates
+// per call: 16 with AVX-512, 8 with AVX2 and 4 otherwise
+size_t MandelbulbLaneCount() {
+#if defined(MANDELBULB_MULTIVERSION)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) return 16;
+  if (__builtin_cpu_supports("avx2")) return 8;
+#endif
+  return 4;
+}
+
+// Evaluates iCount samples (any count) with the kernel selected by
+// MandelbulbLaneCount, the tail is padded with the last sample.
+template<typename T>
+void ComputeMandelbulb8Batch(const double* sx, const double* sy,
+                             const double* sz, size_t iCount,
+                             const T iMaxIterations, const double fBailout,
+                             T* result, size_t iLanes) {
+  double px[16], py[16], pz[16];
+  T pr[16];
+  for (size_t i = 0;i<iCount;i+=iLanes) {
+    const size_t n = std::min(iLanes, iCount-i);
+    for (size_t l = 0;l<iLanes;++l) {
+      const size_t j = i + std::min(l, n-1);
+      px[l] = sx[j]; py[l] = sy[j]; pz[l] = sz[j];
+    }
+    switch (iLanes) {
+      case 16 : ComputeMandelbulb8x16<T>(px, py, pz, iMaxIterations, fBailout, pr); break;
+      case 8  : ComputeMandelbulb8x8<T>(px, py, pz, iMaxIterations, fBailout, pr); break;
+      default : ComputeMandelbulb8x4<T>(px, py, pz, iMaxIterations, fBailout, pr); break;
+    }
+    std::copy(pr, pr+n, result+i);
+  }
+}
+
+#endif // MANDELBULBKERNEL_H
+
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2012 Interactive Visualization and Data Analysis Group
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
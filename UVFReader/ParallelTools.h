@@ -0,0 +1,145 @@
+#ifndef PARALLELTOOLS_H
+#define PARALLELTOOLS_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Number of worker threads to use; 0 means "one per hardware thread".
+unsigned int WorkerCount(unsigned int iRequested = 0) {
+  if (iRequested > 0) return iRequested;
+  const unsigned int iHW = std::thread::hardware_concurrency();
+  return iHW > 0 ? iHW : 1;
+}
+
+// Calls body(i) for every i in [0, iCount) on up to iWorkers threads and
+// returns when all calls are done. Items are handed out one at a time, so
+// items of uneven cost still keep all threads busy.
+template<typename Body>
+void ParallelFor(size_t iCount, unsigned int iWorkers, Body body) {
+  iWorkers = unsigned(std::min<size_t>(std::max(1u, iWorkers), iCount));
+  if (iWorkers <= 1) {
+    for (size_t i = 0; i < iCount; ++i) body(i);
+    return;
+  }
+
+  std::atomic<size_t> iNext(0);
+  std::vector<std::thread> threads;
+  for (unsigned int t = 0; t < iWorkers; ++t)
+    threads.push_back(std::thread([&]() {
+      for (size_t i = iNext++; i < iCount; i = iNext++) body(i);
+    }));
+  for (size_t t = 0; t < threads.size(); ++t) threads[t].join();
+}
+
+// Computes iCount work items on iWorkers threads and hands the results to
+// the calling thread strictly in index order. At most iMaxPending items are
+// in flight (being computed or waiting to be consumed) at any time, so the
+// memory footprint stays bounded no matter how far ahead fast workers get.
+// produce(i, buffer) fills the buffer for item i on a worker thread,
+// consume(i, buffer) runs on the calling thread and may return false to
+// stop the whole pipeline.
+template<typename Producer, typename Consumer>
+bool ProduceOrdered(uint64_t iCount, unsigned int iWorkers,
+                    size_t iMaxPending, Producer produce, Consumer consume) {
+  if (iCount == 0) return true;
+  iWorkers = std::max(1u, iWorkers);
+  iMaxPending = std::max<size_t>(iMaxPending, 1);
+
+  std::mutex m;
+  std::condition_variable cvSlot;
+  std::condition_variable cvReady;
+  std::map<uint64_t, std::vector<uint8_t>> ready;
+  uint64_t iNextTask = 0;
+  uint64_t iNextConsume = 0;
+  bool bAbort = false;
+
+  auto worker = [&]() {
+    for (;;) {
+      uint64_t i;
+      {
+        std::unique_lock<std::mutex> lock(m);
+        cvSlot.wait(lock, [&]() {
+          return bAbort || iNextTask >= iCount ||
+                 iNextTask < iNextConsume + iMaxPending;
+        });
+        if (bAbort || iNextTask >= iCount) return;
+        i = iNextTask++;
+      }
+
+      std::vector<uint8_t> buffer;
+      produce(i, buffer);
+
+      {
+        std::lock_guard<std::mutex> lock(m);
+        ready[i].swap(buffer);
+      }
+      cvReady.notify_one();
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (unsigned int t = 0; t < iWorkers; ++t)
+    threads.push_back(std::thread(worker));
+
+  bool bResult = true;
+  for (uint64_t i = 0; i < iCount; ++i) {
+    std::vector<uint8_t> buffer;
+    {
+      std::unique_lock<std::mutex> lock(m);
+      cvReady.wait(lock, [&]() { return ready.find(i) != ready.end(); });
+      buffer.swap(ready[i]);
+      ready.erase(i);
+    }
+
+    const bool bContinue = consume(i, buffer);
+
+    {
+      std::lock_guard<std::mutex> lock(m);
+      iNextConsume = i+1;
+      if (!bContinue) bAbort = true;
+    }
+    cvSlot.notify_all();
+
+    if (!bContinue) {
+      bResult = false;
+      break;
+    }
+  }
+
+  for (size_t t = 0; t < threads.size(); ++t) threads[t].join();
+  return bResult;
+}
+
+#endif // PARALLELTOOLS_H
+
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2012 Interactive Visualization and Data Analysis Group
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
@@ -0,0 +1,227 @@
+#ifndef SYNTHETICVOLUMES_H
+#define SYNTHETICVOLUMES_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+// Procedural stand-ins for real datasets. Unlike the fractal and the sphere,
+// these mimic the properties that matter for I/O and rendering benchmarks:
+// how well bricks compress, how many of them are empty and how much detail
+// the LODs have to keep. Each generator is a pure function of the sample
+// position (normalized to [0,1]^3), the parameters and the seed, so it can
+// be evaluated for any voxel on any thread. Results are in [0,1].
+//
+// fFrequency sets the feature count along one axis of the volume, fSparsity
+// (in [0,1)) how much of the volume is left empty.
+
+// Counter based random number generator (the SplitMix64 finalizer): the
+// result depends only on the counter and the seed, so voxels can be
+// generated in any order and on any number of threads and still come out
+// the same for the same seed.
+inline uint64_t CounterRandom(uint64_t iCounter, uint64_t iSeed) {
+  uint64_t z = iCounter + iSeed*0xD1B54A32D192ED03ULL + 0x9E3779B97F4A7C15ULL;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+// uniformly distributed in [0,1)
+inline double CounterUniform(uint64_t iCounter, uint64_t iSeed) {
+  return double(CounterRandom(iCounter, iSeed) >> 11) *
+         (1.0/9007199254740992.0);
+}
+
+inline uint64_t LatticeKey(int64_t x, int64_t y, int64_t z) {
+  return uint64_t(x) ^ (uint64_t(y) << 21) ^ (uint64_t(z) << 42);
+}
+
+// a cheaper hash for the gradient noise lattice, which is evaluated eight
+// times per octave and sample; only the top bits are used
+inline uint64_t LatticeHash(int64_t x, int64_t y, int64_t z, uint64_t iSeed) {
+  uint64_t h = iSeed ^ (uint64_t(x)*0x8CB92BA72F3D8DD7ULL) ^
+                       (uint64_t(y)*0xABC98388FB8FAC03ULL) ^
+                       (uint64_t(z)*0xC2B2AE3D27D4EB4FULL);
+  h ^= h >> 32;
+  return h * 0xD6E8FEB86659FD93ULL;
+}
+
+// maps everything below fSparsity to zero and stretches the rest to [0,1]
+inline double ApplySparsity(double v, double fSparsity) {
+  if (v <= fSparsity) return 0.0;
+  return std::min(1.0, (v - fSparsity) / (1.0 - fSparsity));
+}
+
+// inverse of the standard normal CDF (Abramowitz and Stegun 26.2.23,
+// absolute error below 4.5e-4)
+inline double InverseNormalCDF(double p) {
+  const double q = p < 0.5 ? p : 1.0-p;
+  const double t = std::sqrt(-2.0*std::log(q));
+  const double x = t - (2.515517 + 0.802853*t + 0.010328*t*t) /
+                       (1.0 + 1.432788*t + 0.189269*t*t + 0.001308*t*t*t);
+  return p < 0.5 ? -x : x;
+}
+
+inline double NoiseLerp(double t, double a, double b) { return a + t*(b-a); }
+inline double NoiseFade(double t) { return t*t*t*(t*(t*6.0-15.0)+10.0); }
+
+// dot product with one of the 12 cube edge directions of improved noise
+// (padded to 16), looked up rather than branched on since the hash bits
+// are unpredictable by design
+inline double NoiseGradient(uint64_t iHash, double x, double y, double z) {
+  static const double g[16][3] = {
+    { 1, 1, 0}, {-1, 1, 0}, { 1,-1, 0}, {-1,-1, 0},
+    { 1, 0, 1}, {-1, 0, 1}, { 1, 0,-1}, {-1, 0,-1},
+    { 0, 1, 1}, { 0,-1, 1}, { 0, 1,-1}, { 0,-1,-1},
+    { 1, 1, 0}, { 0,-1, 1}, {-1, 1, 0}, { 0,-1,-1}
+  };
+  const double* d = g[iHash >> 60];
+  return d[0]*x + d[1]*y + d[2]*z;
+}
+
+// Perlin's improved gradient noise, the permutation table is replaced by
+// a seeded hash of the lattice point; result in about [-1,1]
+inline double GradientNoise(double x, double y, double z, uint64_t iSeed) {
+  const double fx = std::floor(x), fy = std::floor(y), fz = std::floor(z);
+  const int64_t ix = int64_t(fx), iy = int64_t(fy), iz = int64_t(fz);
+  x -= fx; y -= fy; z -= fz;
+  const double u = NoiseFade(x), v = NoiseFade(y), w = NoiseFade(z);
+
+  double c[8];
+  for (int i = 0;i<8;i++) {
+    const int dx = i&1, dy = (i>>1)&1, dz = (i>>2)&1;
+    c[i] = NoiseGradient(LatticeHash(ix+dx, iy+dy, iz+dz, iSeed),
+                         x-dx, y-dy, z-dz);
+  }
+  return NoiseLerp(w, NoiseLerp(v, NoiseLerp(u, c[0], c[1]),
+                                   NoiseLerp(u, c[2], c[3])),
+                      NoiseLerp(v, NoiseLerp(u, c[4], c[5]),
+                                   NoiseLerp(u, c[6], c[7])));
+}
+
+// Four octaves of gradient noise with fFrequency base features per axis.
+// The normalized sum is close to normally distributed with a standard
+// deviation of about 0.165; +-3 sigma is mapped to [0,1] and the cut off
+// is placed at the matching quantile so fSparsity is the empty fraction.
+inline double NoiseValue(double x, double y, double z, double fFrequency,
+                         double fSparsity, uint64_t iSeed) {
+  static const double fSigma = 0.165;
+  double fSum = 0.0, fAmplitude = 1.0, fNorm = 0.0, f = fFrequency;
+  for (uint64_t o = 0;o<4;o++) {
+    fSum += fAmplitude * GradientNoise(x*f, y*f, z*f, iSeed+o);
+    fNorm += fAmplitude;
+    fAmplitude *= 0.5;
+    f *= 2.0;
+  }
+  const double v = std::max(0.0, std::min(1.0,
+                                          0.5 + fSum/(fNorm*6.0*fSigma)));
+  if (fSparsity <= 0.0) return v;
+  const double fCut = std::max(0.0, std::min(0.99,
+                                 0.5 + InverseNormalCDF(fSparsity)/6.0));
+  return ApplySparsity(v, fCut);
+}
+
+// A CT-like torso along z: an elliptic cylinder of tissue wrapped in skin
+// and a bone shell, fFrequency concentric soft tissue layers, a few seeded
+// spherical organs and a little acquisition noise. Everything outside the
+// body is zero; the cross section is sized so that fSparsity of the volume
+// stays empty, down to about 0.21 where it touches the volume boundary.
+inline double PhantomValue(double x, double y, double z, uint64_t iVoxel,
+                           double fFrequency, double fSparsity,
+                           uint64_t iSeed) {
+  static const double fPi = 3.14159265358979323846;
+  const double fArea = (1.0-fSparsity)/fPi;  // a*b
+  const double a = std::min(0.5, std::sqrt(fArea/0.75));
+  const double b = std::min(0.5, fArea/a);
+  const double dx = (x-0.5)/a, dy = (y-0.5)/b;
+  const double r = std::sqrt(dx*dx + dy*dy);
+  if (r >= 1.0) return 0.0;
+
+  double v;
+  if (r >= 0.95) {
+    v = 0.35;                                  // skin and fat
+  } else if (r >= 0.85) {
+    v = 0.9;                                   // bone
+  } else {
+    const int iLayers = std::max(1, int(fFrequency+0.5));
+    v = (int(r/0.85*iLayers) & 1) ? 0.5 : 0.45; // soft tissue layers
+    for (uint64_t i = 0;i<4;i++) {             // organs
+      const double ox = 0.5 + a*0.5*(CounterUniform(4*i+0, iSeed)-0.5);
+      const double oy = 0.5 + b*0.5*(CounterUniform(4*i+1, iSeed)-0.5);
+      const double oz = 0.2 + 0.6*CounterUniform(4*i+2, iSeed);
+      const double fRadius = a*(0.1 + 0.15*CounterUniform(4*i+3, iSeed));
+      const double d2 = ((x-ox)*(x-ox) + (y-oy)*(y-oy) + (z-oz)*(z-oz)) /
+                        (fRadius*fRadius);
+      if (d2 < 1.0) v = 0.6 + 0.05*double(i);
+    }
+  }
+  v += 0.04*(CounterUniform(iVoxel, iSeed ^ 0x5DEECE66DULL) - 0.5);
+  return std::max(0.0, std::min(1.0, v));
+}
+
+// Sparse particle blobs: the volume is divided into fFrequency^3 cells and
+// each cell holds one smooth blob of random size, position and amplitude,
+// except for a fraction fSparsity of cells that stays empty. Blobs never
+// cross their cell so a voxel only looks at its own cell.
+inline double BlobValue(double x, double y, double z, double fFrequency,
+                        double fSparsity, uint64_t iSeed) {
+  const double fx = x*fFrequency, fy = y*fFrequency, fz = z*fFrequency;
+  const double cx = std::floor(fx), cy = std::floor(fy), cz = std::floor(fz);
+  const uint64_t iKey = LatticeKey(int64_t(cx), int64_t(cy), int64_t(cz));
+  if (CounterUniform(iKey, iSeed) < fSparsity) return 0.0;
+
+  const double r = 0.15 + 0.25*CounterUniform(iKey, iSeed+1);
+  const double px = r + (1.0-2.0*r)*CounterUniform(iKey, iSeed+2);
+  const double py = r + (1.0-2.0*r)*CounterUniform(iKey, iSeed+3);
+  const double pz = r + (1.0-2.0*r)*CounterUniform(iKey, iSeed+4);
+  const double lx = fx-cx-px, ly = fy-cy-py, lz = fz-cz-pz;
+  const double d2 = (lx*lx + ly*ly + lz*lz)/(r*r);
+  if (d2 >= 1.0) return 0.0;
+
+  const double fAmplitude = 0.5 + 0.5*CounterUniform(iKey, iSeed+5);
+  return fAmplitude*(1.0-d2)*(1.0-d2);
+}
+
+// A linear ramp along a seeded direction overlaid with ripples that run at
+// fFrequency along x, a quarter of that along y and not at all along z, so
+// the three axes compress and downsample very differently. Values below
+// fSparsity are cut to zero.
+inline double GradientFieldValue(double x, double y, double z,
+                                 double fFrequency, double fSparsity,
+                                 uint64_t iSeed) {
+  static const double fPi = 3.14159265358979323846;
+  const double dx = CounterUniform(0, iSeed)+0.1;
+  const double dy = CounterUniform(1, iSeed)+0.1;
+  const double dz = CounterUniform(2, iSeed)+0.1;
+  const double fRamp = (dx*x + dy*y + dz*z)/(dx+dy+dz);
+  const double fRipple = 0.5+0.5*std::sin(2.0*fPi*fFrequency*(x + 0.25*y));
+  return ApplySparsity(0.8*fRamp + 0.2*fRipple, fSparsity);
+}
+
+#endif // SYNTHETICVOLUMES_H
+
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2012 Interactive Visualization and Data Analysis Group
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
@@ -0,0 +1,333 @@
+#ifndef UVFCHECKSUM_H
+#define UVFCHECKSUM_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "../Tuvok/StdTuvokDefines.h"
+#include "../Tuvok/Controller/Controller.h"
+#include "../Tuvok/Basics/LargeRAWFile.h"
+#include "../Tuvok/Basics/Timer.h"
+#include "../Tuvok/IO/UVF/UVF.h"
+#include "../Tuvok/IO/UVF/TOCBlock.h"
+#include "../Tuvok/IO/UVF/KeyValuePairDataBlock.h"
+
+#include "ParallelTools.h"
+#include "BrickTools.h"
+
+// Incremental MD5 (RFC 1321). Unlike the hash used by UVF::Open this one
+// carries no file handling, so it can be fed from any thread and any
+// buffer, one instance per stream.
+class StreamMD5 {
+public:
+  StreamMD5() : m_iLength(0), m_iBuffered(0) {
+    m_State[0] = 0x67452301; m_State[1] = 0xefcdab89;
+    m_State[2] = 0x98badcfe; m_State[3] = 0x10325476;
+  }
+
+  void Update(const uint8_t* pData, size_t iSize) {
+    m_iLength += iSize;
+    if (m_iBuffered > 0) {
+      const size_t iCopy = std::min(iSize, size_t(64) - m_iBuffered);
+      memcpy(m_Buffer + m_iBuffered, pData, iCopy);
+      m_iBuffered += iCopy;
+      pData += iCopy;
+      iSize -= iCopy;
+      if (m_iBuffered < 64) return;
+      Transform(m_Buffer);
+      m_iBuffered = 0;
+    }
+    for (;iSize >= 64;pData += 64, iSize -= 64) Transform(pData);
+    memcpy(m_Buffer, pData, iSize);
+    m_iBuffered = iSize;
+  }
+
+  std::vector<uint8_t> Final() {
+    const uint64_t iBits = m_iLength*8;
+    uint8_t pad[72] = {0x80};
+    const size_t iPad = (m_iBuffered < 56) ? 56 - m_iBuffered
+                                           : 120 - m_iBuffered;
+    for (size_t i = 0;i<8;i++) pad[iPad+i] = uint8_t(iBits >> (8*i));
+    Update(pad, iPad+8);
+
+    std::vector<uint8_t> digest(16);
+    for (size_t i = 0;i<16;i++) digest[i] = uint8_t(m_State[i/4] >> (8*(i%4)));
+    return digest;
+  }
+
+private:
+  uint32_t m_State[4];
+  uint64_t m_iLength;
+  size_t   m_iBuffered;
+  uint8_t  m_Buffer[64];
+
+  static uint32_t Rotate(uint32_t x, unsigned int s) {
+    return (x << s) | (x >> (32-s));
+  }
+
+  void Transform(const uint8_t* pBlock) {
+    static const uint32_t K[64] = {
+      0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a,
+      0xa8304613, 0xfd469501, 0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be,
+      0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821, 0xf61e2562, 0xc040b340,
+      0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+      0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8,
+      0x676f02d9, 0x8d2a4c8a, 0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c,
+      0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70, 0x289b7ec6, 0xeaa127fa,
+      0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+      0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92,
+      0xffeff47d, 0x85845dd1, 0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1,
+      0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391
+    };
+    static const unsigned int S[16] = {7, 12, 17, 22, 5, 9, 14, 20,
+                                       4, 11, 16, 23, 6, 10, 15, 21};
+
+    // MD5 words are little endian regardless of the host
+    uint32_t M[16];
+    for (size_t i = 0;i<16;i++)
+      M[i] = uint32_t(pBlock[4*i])         | uint32_t(pBlock[4*i+1]) << 8 |
+             uint32_t(pBlock[4*i+2]) << 16 | uint32_t(pBlock[4*i+3]) << 24;
+
+    uint32_t a = m_State[0], b = m_State[1], c = m_State[2], d = m_State[3];
+    // one loop per round keeps the round function out of the inner loop,
+    // so the compiler can unroll all of them
+    #define MD5_STEP(F, g)                                              \
+      { const uint32_t f = a + (F) + K[i] + M[(g)];                    \
+        a = d; d = c; c = b;                                            \
+        b = b + Rotate(f, S[(i/16)*4 + i%4]); }
+    unsigned int i = 0;
+    for (;i<16;i++) MD5_STEP((b & c) | (~b & d), i)
+    for (;i<32;i++) MD5_STEP((d & b) | (~d & c), (5*i+1)%16)
+    for (;i<48;i++) MD5_STEP(b ^ c ^ d,          (3*i+5)%16)
+    for (;i<64;i++) MD5_STEP(c ^ (b | ~d),       (7*i)%16)
+    #undef MD5_STEP
+    m_State[0] += a; m_State[1] += b; m_State[2] += c; m_State[3] += d;
+  }
+};
+
+std::string DigestToString(const std::vector<uint8_t>& vDigest) {
+  static const char hex[] = "0123456789abcdef";
+  std::string str;
+  for (size_t i = 0;i<vDigest.size();i++) {
+    str += hex[vDigest[i] >> 4];
+    str += hex[vDigest[i] & 15];
+  }
+  return str;
+}
+
+struct ChecksumStats {
+  uint64_t iBytes;
+  double   fSeconds;
+  double Throughput() const {  // MB/s
+    return fSeconds > 0 ? double(iBytes)/(1024.0*1024.0)/fSeconds : 0.0;
+  }
+};
+
+// Hashes the file from iOffset to its end. One worker reads the next chunk
+// while the calling thread hashes the current one, so disk and CPU are busy
+// at the same time. Chunks are iChunkSize large and, apart from the first
+// one, start at multiples of iChunkSize in the file.
+bool ComputeFileMD5(const std::string& strFile, uint64_t iOffset,
+                    std::vector<uint8_t>& vDigest, ChecksumStats& stats,
+                    uint64_t iChunkSize = 8*1024*1024) {
+  LargeRAWFile file(strFile);
+  if (!file.Open(false)) return false;
+
+  const uint64_t iFileSize = file.GetCurrentSize();
+  if (iOffset > iFileSize) {
+    file.Close();
+    return false;
+  }
+
+  const uint64_t iFirstEnd = std::min(iFileSize,
+                                      (iOffset/iChunkSize + 1)*iChunkSize);
+  const uint64_t iChunks = (iFirstEnd - iOffset > 0 ? 1 : 0) +
+                           (iFileSize - iFirstEnd + iChunkSize - 1)/iChunkSize;
+
+  Timer timer;
+  timer.Start();
+
+  StreamMD5 md5;
+  bool bReadError = false;
+  ProduceOrdered(iChunks, 1, 2,
+    [&](uint64_t i, std::vector<uint8_t>& chunk) {
+      const uint64_t iStart = (i == 0) ? iOffset
+                                       : iFirstEnd + (i-1)*iChunkSize;
+      const uint64_t iEnd = (i == 0) ? iFirstEnd
+                                     : std::min(iFileSize, iStart+iChunkSize);
+      chunk.resize(size_t(iEnd-iStart));
+      // the chunks are requested in order, so no seek is needed after the
+      // first one
+      if (i == 0) file.SeekPos(iStart);
+      if (file.ReadRAW(chunk.data(), chunk.size()) != chunk.size())
+        chunk.clear();
+    },
+    [&](uint64_t i, const std::vector<uint8_t>& chunk) {
+      if (chunk.empty()) {
+        bReadError = true;
+        return false;
+      }
+      md5.Update(chunk.data(), chunk.size());
+      MESSAGE("Verifying checksum %.1f%%", 100.0*double(i+1)/double(iChunks));
+      return true;
+    });
+  file.Close();
+  if (bReadError) return false;
+
+  vDigest = md5.Final();
+  stats.iBytes = iFileSize - iOffset;
+  stats.fSeconds = timer.Elapsed()/1000.0;
+  return true;
+}
+
+// Recomputes the MD5 checksum of an UVF file and compares it with the one
+// stored in its global header. The checksum covers everything behind the
+// stored checksum bytes, i.e. from byte 33 + checksum length (magic, endian
+// flag, version, checksum semantic and length come first) to the end of
+// the file.
+bool VerifyUVFChecksum(const std::string& strUVFName, const GlobalHeader& gh,
+                       ChecksumStats& stats, std::string& strProblem) {
+  if (gh.ulChecksumSemanticsEntry != UVFTables::CS_MD5) {
+    strProblem = "file does not use an MD5 checksum";
+    return false;
+  }
+
+  std::vector<uint8_t> vDigest;
+  if (!ComputeFileMD5(strUVFName, 33 + gh.vcChecksum.size(), vDigest, stats)) {
+    strProblem = "unable to read the file";
+    return false;
+  }
+  if (vDigest != gh.vcChecksum) {
+    strProblem = "checksum mismatch, stored " +
+                 DigestToString(gh.vcChecksum) + " but computed " +
+                 DigestToString(vDigest);
+    return false;
+  }
+  return true;
+}
+
+// Per brick checksums live in a key value block with this ID, one pair
+// per brick of the first TOC block: "lod x y z" -> MD5 of the
+// uncompressed brick data.
+static const char* const BRICK_CHECKSUM_BLOCK_ID = "Brick Checksums";
+
+// The checksum of one brick as stored in the brick checksum block.
+std::string BrickChecksum(const std::vector<uint8_t>& data) {
+  StreamMD5 md5;
+  md5.Update(data.data(), data.size());
+  return DigestToString(md5.Final());
+}
+
+// Builds the brick checksum block for a freshly bricked volume from the
+// checksums of all its bricks, computed while the bricks are read anyway.
+std::shared_ptr<KeyValuePairDataBlock>
+CreateBrickChecksumBlock(const std::vector<UINT64VECTOR4>& vBricks,
+                         const std::vector<std::string>& vChecksums) {
+  std::shared_ptr<KeyValuePairDataBlock> checksums(
+    new KeyValuePairDataBlock()
+  );
+  checksums->strBlockID = BRICK_CHECKSUM_BLOCK_ID;
+  for (size_t i = 0;i<vBricks.size();i++)
+    checksums->AddPair(BrickKeyToString(vBricks[i]), vChecksums[i]);
+  return checksums;
+}
+
+// Verifies every brick against the brick checksum block, reading and
+// hashing the bricks in parallel. The keys of all damaged bricks are
+// returned in vDamaged.
+bool VerifyBrickChecksums(const std::string& strUVFName,
+                          unsigned int iWorkers,
+                          std::vector<std::string>& vDamaged,
+                          ChecksumStats& stats, std::string& strProblem) {
+  const std::wstring wstrUVFName(strUVFName.begin(), strUVFName.end());
+  std::map<std::string, std::string> expected;
+  std::vector<UINT64VECTOR4> vBricks;
+  {
+    UVF uvfFile(wstrUVFName);
+    if (!uvfFile.Open(false, false, false, &strProblem)) return false;
+
+    const TOCBlock* toc = NULL;
+    const KeyValuePairDataBlock* kvp = NULL;
+    for (uint64_t i = 0;i<uvfFile.GetDataBlockCount();i++) {
+      const DataBlock* b = uvfFile.GetDataBlock(i).get();
+      if (!toc && b->GetBlockSemantic() == UVFTables::BS_TOC_BLOCK)
+        toc = dynamic_cast<const TOCBlock*>(b);
+      if (!kvp && b->GetBlockSemantic() == UVFTables::BS_KEY_VALUE_PAIRS &&
+          b->strBlockID == BRICK_CHECKSUM_BLOCK_ID)
+        kvp = dynamic_cast<const KeyValuePairDataBlock*>(b);
+    }
+    if (!toc || !kvp) {
+      strProblem = "file has no brick checksums";
+      uvfFile.Close();
+      return false;
+    }
+    for (size_t i = 0;i<kvp->GetKeyCount();i++)
+      expected[kvp->GetKeyByIndex(i)] = kvp->GetValueByIndex(i);
+    vBricks = EnumerateBricks(toc);
+    uvfFile.Close();
+  }
+
+  Timer timer;
+  timer.Start();
+
+  std::atomic<uint64_t> iBytes(0);
+  std::mutex resultMutex;
+  std::vector<size_t> vBad;
+  const bool bRead = ForEachBrick(strUVFName, vBricks, iWorkers,
+    [&](unsigned int, size_t i, const TOCBlock*,
+        const std::vector<uint8_t>& data) {
+      iBytes += data.size();
+      std::map<std::string, std::string>::const_iterator e =
+        expected.find(BrickKeyToString(vBricks[i]));
+      if (e == expected.end() || e->second != BrickChecksum(data)) {
+        std::lock_guard<std::mutex> lock(resultMutex);
+        vBad.push_back(i);
+      }
+    }, strProblem);
+  if (!bRead) return false;
+
+  std::sort(vBad.begin(), vBad.end());
+  vDamaged.clear();
+  for (size_t i = 0;i<vBad.size();i++)
+    vDamaged.push_back(BrickKeyToString(vBricks[vBad[i]]));
+
+  stats.iBytes = iBytes;
+  stats.fSeconds = timer.Elapsed()/1000.0;
+  return true;
+}
+
+#endif // UVFCHECKSUM_H
+
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2012 Interactive Visualization and Data Analysis Group
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
@@ -0,0 +1,368 @@
+#ifndef UVFCOMPARE_H
+#define UVFCOMPARE_H
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <limits>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+
+#include "../Tuvok/StdTuvokDefines.h"
+#include "../Tuvok/Basics/Vectors.h"
+#include "../Tuvok/Basics/Timer.h"
+#include "../Tuvok/IO/UVF/UVF.h"
+#include "../Tuvok/IO/UVF/TOCBlock.h"
+
+#include "BrickTools.h"
+#include "UVFReport.h"
+
+struct VoxelDifference {
+  UINT64VECTOR3 vPosition;
+  uint64_t      iComponent;
+  double        fFirst;
+  double        fSecond;
+};
+
+// Differences are listed in scanline order of the volume.
+bool operator<(const VoxelDifference& a, const VoxelDifference& b) {
+  if (a.vPosition.z != b.vPosition.z) return a.vPosition.z < b.vPosition.z;
+  if (a.vPosition.y != b.vPosition.y) return a.vPosition.y < b.vPosition.y;
+  if (a.vPosition.x != b.vPosition.x) return a.vPosition.x < b.vPosition.x;
+  return a.iComponent < b.iComponent;
+}
+
+struct CompareResult {
+  UINT64VECTOR3 vDomainSize;
+  uint64_t      iComponentCount;
+  uint64_t      iValues;
+  uint64_t      iDifferentValues;
+  double        fMaxAbsError;
+  double        fSumSquaredError;
+  double        fMin;       // value range of the first file, the
+  double        fMax;       // peak signal of the PSNR
+  double        fSeconds;
+  std::vector<VoxelDifference> vFirstDifferences;
+
+  double MeanSquaredError() const {
+    return iValues ? fSumSquaredError / double(iValues) : 0.0;
+  }
+  // infinite for identical volumes
+  double PSNR() const {
+    const double fMSE = MeanSquaredError();
+    if (fMSE == 0.0) return std::numeric_limits<double>::infinity();
+    const double fPeak = fMax > fMin ? fMax - fMin : 1.0;
+    return 10.0 * std::log10(fPeak * fPeak / fMSE);
+  }
+};
+
+// Compares one region that was read from both files into the same layout.
+// At most iMaxDifferences differences are recorded, the first ones in
+// scanline order of the region.
+template<typename T>
+void CompareRegion(const uint8_t* pFirst, const uint8_t* pSecond,
+                   const UINT64VECTOR3& vOffset, const UINT64VECTOR3& vSize,
+                   size_t iComponents, size_t iMaxDifferences,
+                   CompareResult& result) {
+  const size_t iRowValues = size_t(vSize.x) * iComponents;
+  T tMin = std::numeric_limits<T>::max();
+  T tMax = std::numeric_limits<T>::lowest();
+  for (uint64_t z = 0;z<vSize.z;z++) {
+    for (uint64_t y = 0;y<vSize.y;y++) {
+      const size_t iRow = size_t(z * vSize.y + y) * iRowValues;
+      const T* a = reinterpret_cast<const T*>(pFirst) + iRow;
+      const T* b = reinterpret_cast<const T*>(pSecond) + iRow;
+      for (size_t i = 0;i<iRowValues;i++) {
+        tMin = std::min(tMin, a[i]);
+        tMax = std::max(tMax, a[i]);
+      }
+      // identical data is the common case, skip it as a whole
+      if (std::memcmp(a, b, iRowValues * sizeof(T)) == 0) continue;
+
+      for (size_t i = 0;i<iRowValues;i++) {
+        if (a[i] == b[i]) continue;
+        const double fError = std::fabs(double(a[i]) - double(b[i]));
+        result.iDifferentValues++;
+        result.fMaxAbsError = std::max(result.fMaxAbsError, fError);
+        result.fSumSquaredError += fError * fError;
+        if (result.vFirstDifferences.size() < iMaxDifferences) {
+          const VoxelDifference d = {
+            UINT64VECTOR3(vOffset.x + i / iComponents, vOffset.y + y,
+                          vOffset.z + z),
+            uint64_t(i % iComponents), double(a[i]), double(b[i])
+          };
+          result.vFirstDifferences.push_back(d);
+        }
+      }
+    }
+  }
+  result.iValues += vSize.volume() * iComponents;
+  result.fMin = std::min(result.fMin, double(tMin));
+  result.fMax = std::max(result.fMax, double(tMax));
+}
+
+void CompareRegion(ExtendedOctree::COMPONENT_TYPE eType,
+                   const uint8_t* pFirst, const uint8_t* pSecond,
+                   const UINT64VECTOR3& vOffset, const UINT64VECTOR3& vSize,
+                   size_t iComponents, size_t iMaxDifferences,
+                   CompareResult& result) {
+  switch (eType) {
+#define COMPARE(CT, T)                                                      \
+    case ExtendedOctree::CT :                                               \
+      CompareRegion<T>(pFirst, pSecond, vOffset, vSize, iComponents,        \
+                       iMaxDifferences, result);                            \
+      break;
+    COMPARE(CT_UINT8,   uint8_t)
+    COMPARE(CT_INT8,    int8_t)
+    COMPARE(CT_UINT16,  uint16_t)
+    COMPARE(CT_INT16,   int16_t)
+    COMPARE(CT_UINT32,  uint32_t)
+    COMPARE(CT_INT32,   int32_t)
+    COMPARE(CT_UINT64,  uint64_t)
+    COMPARE(CT_INT64,   int64_t)
+    COMPARE(CT_FLOAT32, float)
+    COMPARE(CT_FLOAT64, double)
+#undef COMPARE
+  }
+}
+
+// Compares the finest LoD of the TOC volumes of two files voxel by voxel.
+// Brick sizes, overlap, layout and compression of the files may differ:
+// the file with the larger bricks drives the comparison, every worker
+// decompresses one of its bricks and reads the same region from the
+// bricks of the other file. Both files are opened once per worker since
+// reading from a TOC block is not thread safe.
+bool CompareVolumes(const std::string& strFirst,
+                    const std::string& strSecond, size_t iMaxDifferences,
+                    unsigned int iWorkers, CompareResult& result,
+                    std::string& strProblem) {
+  ExtendedOctree::COMPONENT_TYPE eType;
+  size_t iComponents;
+  bool bFirstDrives;
+  std::vector<UINT64VECTOR4> vBricks;
+  {
+    const std::wstring wstrFirst(strFirst.begin(), strFirst.end());
+    const std::wstring wstrSecond(strSecond.begin(), strSecond.end());
+    UVF first(wstrFirst);
+    UVF second(wstrSecond);
+    const TOCBlock* tocFirst = first.Open(false, false, false, &strProblem)
+                               ? FindTOCBlock(first) : NULL;
+    const TOCBlock* tocSecond = second.Open(false, false, false, &strProblem)
+                                ? FindTOCBlock(second) : NULL;
+    if (!tocFirst || !tocSecond) {
+      if (strProblem.empty())
+        strProblem = "only files with a TOC volume can be compared";
+      return false;
+    }
+    if (tocFirst->GetLODDomainSize(0) != tocSecond->GetLODDomainSize(0)) {
+      strProblem = "the volumes differ in size";
+    } else if (tocFirst->GetComponentType() !=
+               tocSecond->GetComponentType()) {
+      strProblem = "the volumes differ in data type";
+    } else if (tocFirst->GetComponentCount() !=
+               tocSecond->GetComponentCount()) {
+      strProblem = "the volumes differ in the number of components";
+    }
+    result.vDomainSize = tocFirst->GetLODDomainSize(0);
+    eType = tocFirst->GetComponentType();
+    iComponents = size_t(tocFirst->GetComponentCount());
+    bFirstDrives = InnerBrickSize(tocFirst).volume() >=
+                   InnerBrickSize(tocSecond).volume();
+    vBricks = LoDBricks(bFirstDrives ? tocFirst : tocSecond, 0);
+    first.Close();
+    second.Close();
+    if (!strProblem.empty()) return false;
+  }
+
+  result.iComponentCount = iComponents;
+  result.iValues = 0;
+  result.iDifferentValues = 0;
+  result.fMaxAbsError = 0.0;
+  result.fSumSquaredError = 0.0;
+  result.fMin = std::numeric_limits<double>::max();
+  result.fMax = std::numeric_limits<double>::lowest();
+  result.vFirstDifferences.clear();
+
+  const std::string& strDriver = bFirstDrives ? strFirst : strSecond;
+  const std::string& strOther = bFirstDrives ? strSecond : strFirst;
+  const std::wstring wstrDriver(strDriver.begin(), strDriver.end());
+  const std::wstring wstrOther(strOther.begin(), strOther.end());
+  if (vBricks.size() < iWorkers) iWorkers = unsigned(vBricks.size());
+  iWorkers = std::max(1u, iWorkers);
+
+  Timer timer;
+  timer.Start();
+  std::mutex resultMutex;
+  std::atomic<uint64_t> iNext(0);
+  std::atomic<bool> bOpenFailed(false);
+  std::vector<std::thread> threads;
+  for (unsigned int t = 0;t<iWorkers;t++) {
+    threads.push_back(std::thread([&]() {
+      UVF driver(wstrDriver);
+      UVF other(wstrOther);
+      const TOCBlock* tocDriver = driver.Open(false, false, false)
+                                  ? FindTOCBlock(driver) : NULL;
+      const TOCBlock* tocOther = other.Open(false, false, false)
+                                 ? FindTOCBlock(other) : NULL;
+      if (!tocDriver || !tocOther) {
+        bOpenFailed = true;
+        return;
+      }
+
+      const uint64_t iOverlap = tocDriver->GetOverlap();
+      const UINT64VECTOR3 vInner = InnerBrickSize(tocDriver);
+      std::vector<uint8_t> vBrick;
+      std::vector<uint8_t> vDriverRegion;
+      std::vector<uint8_t> vOtherRegion;
+      for (uint64_t i = iNext++;i<vBricks.size() && !bOpenFailed;
+           i = iNext++) {
+        const UINT64VECTOR4& key = vBricks[size_t(i)];
+        const UINT64VECTOR3 vBrickSize = tocDriver->GetBrickSize(key);
+        const UINT64VECTOR3 vOffset(key.x * vInner.x, key.y * vInner.y,
+                                    key.z * vInner.z);
+        const UINT64VECTOR3 vSize(vBrickSize.x - 2 * iOverlap,
+                                  vBrickSize.y - 2 * iOverlap,
+                                  vBrickSize.z - 2 * iOverlap);
+        vBrick.resize(BrickBytes(tocDriver, key));
+        tocDriver->GetData(vBrick.data(), key);
+        vDriverRegion.resize(vBrick.size());
+        CopyBrickIntoRegion(tocDriver, key, vBrick.data(), vOffset, vSize,
+                            vDriverRegion.data());
+        ReadTOCRegion(tocOther, 0, vOffset, vSize, vBrick, vOtherRegion);
+
+        CompareResult brick;
+        brick.iValues = 0;
+        brick.iDifferentValues = 0;
+        brick.fMaxAbsError = 0.0;
+        brick.fSumSquaredError = 0.0;
+        brick.fMin = std::numeric_limits<double>::max();
+        brick.fMax = std::numeric_limits<double>::lowest();
+        CompareRegion(eType, bFirstDrives ? vDriverRegion.data()
+                                          : vOtherRegion.data(),
+                      bFirstDrives ? vOtherRegion.data()
+                                   : vDriverRegion.data(),
+                      vOffset, vSize, iComponents, iMaxDifferences, brick);
+
+        std::lock_guard<std::mutex> lock(resultMutex);
+        result.iValues += brick.iValues;
+        result.iDifferentValues += brick.iDifferentValues;
+        result.fMaxAbsError = std::max(result.fMaxAbsError,
+                                       brick.fMaxAbsError);
+        result.fSumSquaredError += brick.fSumSquaredError;
+        result.fMin = std::min(result.fMin, brick.fMin);
+        result.fMax = std::max(result.fMax, brick.fMax);
+        if (!brick.vFirstDifferences.empty()) {
+          result.vFirstDifferences.insert(result.vFirstDifferences.end(),
+                                          brick.vFirstDifferences.begin(),
+                                          brick.vFirstDifferences.end());
+          std::sort(result.vFirstDifferences.begin(),
+                    result.vFirstDifferences.end());
+          if (result.vFirstDifferences.size() > iMaxDifferences)
+            result.vFirstDifferences.resize(iMaxDifferences);
+        }
+      }
+      driver.Close();
+      other.Close();
+    }));
+  }
+  for (size_t t = 0;t<threads.size();t++) threads[t].join();
+  result.fSeconds = timer.Elapsed()/1000.0;
+
+  if (bOpenFailed) {
+    strProblem = "unable to open the TOC blocks of " + strFirst + " and " +
+                 strSecond;
+    return false;
+  }
+  return true;
+}
+
+void PrintComparison(const std::string& strFirst,
+                     const std::string& strSecond,
+                     const CompareResult& result, std::ostream& out) {
+  out << "Comparison of " << strFirst << " and " << strSecond << "\n"
+      << "  Domain " << result.vDomainSize.x << " x "
+      << result.vDomainSize.y << " x " << result.vDomainSize.z << ", "
+      << result.iComponentCount << " component(s), " << result.iValues
+      << " values compared in " << result.fSeconds << " s\n";
+  if (result.iDifferentValues == 0) {
+    out << "  The volumes are identical\n";
+    out.flush();
+    return;
+  }
+  out << "  " << result.iDifferentValues << " values differ\n"
+      << "  Max abs error: " << result.fMaxAbsError << "\n"
+      << "  MSE: " << result.MeanSquaredError() << "\n"
+      << "  PSNR: " << result.PSNR() << " dB\n";
+  for (size_t i = 0;i<result.vFirstDifferences.size();i++) {
+    const VoxelDifference& d = result.vFirstDifferences[i];
+    out << "    (" << d.vPosition.x << ", " << d.vPosition.y << ", "
+        << d.vPosition.z << ")";
+    if (result.iComponentCount > 1) out << " component " << d.iComponent;
+    out << ": " << d.fFirst << " vs. " << d.fSecond << "\n";
+  }
+  out.flush();
+}
+
+void ReportComparison(const std::string& strFirst,
+                      const std::string& strSecond,
+                      const CompareResult& result, ReportWriter& r) {
+  r.BeginObject("comparison");
+  r.Value("first", strFirst);
+  r.Value("second", strSecond);
+  r.Vector3("domain_size", result.vDomainSize);
+  r.Value("components", result.iComponentCount);
+  r.Value("values", result.iValues);
+  r.Value("seconds", result.fSeconds);
+  r.Value("identical", result.iDifferentValues == 0);
+  r.Value("different_values", result.iDifferentValues);
+  r.Value("max_abs_error", result.fMaxAbsError);
+  r.Value("mse", result.MeanSquaredError());
+  // null in JSON for identical volumes
+  r.Value("psnr", result.PSNR());
+  r.BeginArray("differences");
+  for (size_t i = 0;i<result.vFirstDifferences.size();i++) {
+    const VoxelDifference& d = result.vFirstDifferences[i];
+    r.BeginObject();
+    r.Vector3("position", d.vPosition);
+    r.Value("component", d.iComponent);
+    r.Value("first", d.fFirst);
+    r.Value("second", d.fSecond);
+    r.EndObject();
+  }
+  r.EndArray();
+  r.EndObject();
+}
+
+#endif // UVFCOMPARE_H
+
+
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2012 Interactive Visualization and Data Analysis Group
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
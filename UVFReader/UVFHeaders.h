@@ -0,0 +1,208 @@
+#ifndef UVFHEADERS_H
+#define UVFHEADERS_H
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <cstdint>
+
+#include "../Tuvok/StdTuvokDefines.h"
+#include "../Tuvok/Basics/SysTools.h"
+#include "../Tuvok/Basics/LargeRAWFile.h"
+#include "../Tuvok/IO/UVF/UVFTables.h"
+
+#include "UVFReport.h"
+
+// Header of one data block as found in the file, without its payload.
+struct UVFBlockHeader {
+  std::string                     strBlockID;
+  UVFTables::BlockSemanticTable   eSemantic;
+  UVFTables::CompressionSemantic  eCompression;
+  uint64_t                        iOffset;       // of the block in the file
+  uint64_t                        iHeaderSize;
+  uint64_t                        iPayloadSize;  // up to the next block
+};
+
+struct UVFHeaderListing {
+  uint64_t                     iFileSize;
+  bool                         bIsBigEndian;
+  uint64_t                     iVersion;
+  UVFTables::ChecksumSemantic  eChecksum;
+  uint64_t                     iChecksumBytes;
+  uint64_t                     iAdditionalHeaderSize;
+  std::vector<UVFBlockHeader>  vBlocks;
+};
+
+// Walks the chain of block headers of a UVF file without reading any
+// payload, so even huge files are listed with a handful of small reads.
+// The layout follows the UVF specification:
+//   global header: "UVF-DATA", endianess (1 byte), version, checksum
+//                  semantic, checksum length, checksum, size of the
+//                  additional header, additional header
+//   every block:   ID length, ID, block semantic, compression, offset from
+//                  this block to the next one (0 for the last block),
+//                  payload
+bool ReadUVFHeaders(const std::string& strUVFName, UVFHeaderListing& listing,
+                    std::string& strProblem) {
+  LargeRAWFile file(strUVFName);
+  if (!file.Open(false)) {
+    strProblem = "unable to open " + strUVFName;
+    return false;
+  }
+  listing.iFileSize = file.GetCurrentSize();
+  listing.vBlocks.clear();
+
+  unsigned char magic[8];
+  unsigned char endian = 0;
+  if (listing.iFileSize < 33 || file.ReadRAW(magic, 8) != 8 ||
+      std::string(reinterpret_cast<char*>(magic), 8) != "UVF-DATA" ||
+      file.ReadRAW(&endian, 1) != 1) {
+    strProblem = "not a UVF file";
+    file.Close();
+    return false;
+  }
+  const bool bBig = endian != 0;
+  listing.bIsBigEndian = bBig;
+
+  uint64_t iSemantic = 0;
+  file.ReadData(listing.iVersion, bBig);
+  file.ReadData(iSemantic, bBig);
+  file.ReadData(listing.iChecksumBytes, bBig);
+  listing.eChecksum = UVFTables::ChecksumSemantic(iSemantic);
+  if (33 + listing.iChecksumBytes + 8 > listing.iFileSize) {
+    strProblem = "global header is truncated";
+    file.Close();
+    return false;
+  }
+  file.SeekPos(33 + listing.iChecksumBytes);
+  file.ReadData(listing.iAdditionalHeaderSize, bBig);
+
+  uint64_t iOffset = 33 + listing.iChecksumBytes + 8 +
+                     listing.iAdditionalHeaderSize;
+  while (iOffset < listing.iFileSize) {
+    file.SeekPos(iOffset);
+    UVFBlockHeader h;
+    h.iOffset = iOffset;
+
+    uint64_t iIDLength = 0;
+    file.ReadData(iIDLength, bBig);
+    if (iIDLength > listing.iFileSize - iOffset) {
+      strProblem = "block header at offset " + SysTools::ToString(iOffset) +
+                   " is damaged";
+      file.Close();
+      return false;
+    }
+    h.strBlockID.resize(size_t(iIDLength));
+    if (iIDLength > 0)
+      file.ReadRAW(reinterpret_cast<unsigned char*>(&h.strBlockID[0]),
+                   iIDLength);
+
+    uint64_t iBlockSemantic = 0;
+    uint64_t iCompression = 0;
+    uint64_t iOffsetToNext = 0;
+    file.ReadData(iBlockSemantic, bBig);
+    file.ReadData(iCompression, bBig);
+    file.ReadData(iOffsetToNext, bBig);
+    h.eSemantic = UVFTables::BlockSemanticTable(iBlockSemantic);
+    h.eCompression = UVFTables::CompressionSemantic(iCompression);
+    h.iHeaderSize = file.GetPos() - iOffset;
+
+    const uint64_t iEnd = iOffsetToNext ? iOffset + iOffsetToNext
+                                        : listing.iFileSize;
+    if (iEnd > listing.iFileSize || iEnd < iOffset + h.iHeaderSize) {
+      strProblem = "block " + SysTools::ToString(listing.vBlocks.size()) +
+                   " points outside of the file";
+      file.Close();
+      return false;
+    }
+    h.iPayloadSize = iEnd - iOffset - h.iHeaderSize;
+    listing.vBlocks.push_back(h);
+
+    if (iOffsetToNext == 0) break;
+    iOffset = iEnd;
+  }
+  file.Close();
+  return true;
+}
+
+void PrintUVFHeaders(const std::string& strUVFName,
+                     const UVFHeaderListing& listing, std::ostream& out) {
+  out << "Headers of UVF File " << strUVFName << " (" << listing.iFileSize
+      << " bytes)\n"
+      << "  " << (listing.bIsBigEndian ? "Big" : "Little")
+      << " endian, version " << listing.iVersion << ", "
+      << UVFTables::ChecksumSemanticToCharString(listing.eChecksum)
+      << " checksum of " << listing.iChecksumBytes*8 << " bits\n";
+  if (listing.iAdditionalHeaderSize > 0)
+    out << "  Additional header of " << listing.iAdditionalHeaderSize
+        << " bytes\n";
+  out << "  " << listing.vBlocks.size() << " block(s)\n";
+  for (size_t i = 0;i<listing.vBlocks.size();i++) {
+    const UVFBlockHeader& h = listing.vBlocks[i];
+    out << "    Block " << i << ": " << h.strBlockID << "\n"
+        << "      Data is of type: "
+        << UVFTables::BlockSemanticTableToCharString(h.eSemantic) << "\n"
+        << "      Global Block Compression is : "
+        << UVFTables::CompressionSemanticToCharString(h.eCompression)
+        << "\n"
+        << "      Offset " << h.iOffset << ", header " << h.iHeaderSize
+        << " bytes, payload " << h.iPayloadSize << " bytes\n";
+  }
+  out.flush();
+}
+
+void ReportUVFHeaders(const std::string& strUVFName,
+                      const UVFHeaderListing& listing, ReportWriter& r) {
+  r.BeginObject(strUVFName);
+  r.Value("file", strUVFName);
+  r.Value("file_size", listing.iFileSize);
+  r.Value("big_endian", listing.bIsBigEndian);
+  r.Value("version", listing.iVersion);
+  r.Value("checksum",
+          UVFTables::ChecksumSemanticToCharString(listing.eChecksum));
+  r.Value("checksum_bits", listing.iChecksumBytes*8);
+  r.Value("additional_header_size", listing.iAdditionalHeaderSize);
+  r.BeginArray("blocks");
+  for (size_t i = 0;i<listing.vBlocks.size();i++) {
+    const UVFBlockHeader& h = listing.vBlocks[i];
+    r.BeginObject();
+    r.Value("id", h.strBlockID);
+    r.Value("type", UVFTables::BlockSemanticTableToCharString(h.eSemantic));
+    r.Value("compression",
+            UVFTables::CompressionSemanticToCharString(h.eCompression));
+    r.Value("offset", h.iOffset);
+    r.Value("header_size", h.iHeaderSize);
+    r.Value("payload_size", h.iPayloadSize);
+    r.EndObject();
+  }
+  r.EndArray();
+  r.EndObject();
+}
+
+#endif // UVFHEADERS_H
+
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2012 Interactive Visualization and Data Analysis Group
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
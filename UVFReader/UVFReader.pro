@@ -68,7 +68,20 @@ contains(QMAKE_PRL_CONFIG, shared) {
 # Input
 HEADERS += ../CmdLineConverter/DebugOut/HRConsoleOut.h \
            DataSource.h \
-           BlockInfo.h
+           BlockInfo.h \
+           ParallelTools.h \
+           MandelbulbKernel.h \
+           SyntheticVolumes.h \
+           UVFChecksum.h \
+           UVFReport.h \
+           BrickTools.h \
+           BrickBenchmark.h \
+           AccessSimulator.h \
+           VolumeDump.h \
+           VolumeStatistics.h \
+           HistogramTools.h \
+           UVFHeaders.h \
+           UVFCompare.h
 
 
 SOURCES += ../CmdLineConverter/DebugOut/HRConsoleOut.cpp \
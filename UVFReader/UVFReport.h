@@ -0,0 +1,236 @@
+#ifndef UVFREPORT_H
+#define UVFREPORT_H
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <limits>
+#include <type_traits>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+
+enum EReportFormat {
+  RF_TEXT = 0,
+  RF_JSON,
+  RF_CSV
+};
+
+// Writes nested records of named values either as (indented) JSON or as
+// CSV rows "path,key,value", where path names the enclosing objects and
+// array indices separated by '/'. Output is collected in memory and handed
+// to the stream in large pieces instead of line by line.
+class ReportWriter {
+public:
+  ReportWriter(std::ostream& out, EReportFormat eFormat,
+               size_t iFlushSize = 1024*1024) :
+    m_out(out),
+    m_eFormat(eFormat),
+    m_iFlushSize(iFlushSize)
+  {
+    m_strBuffer.reserve(iFlushSize + 4096);
+  }
+
+  ~ReportWriter() {
+    Flush();
+  }
+
+  // header line of the CSV format, to be written once per output
+  static const char* CSVHeader() { return "path,key,value\n"; }
+
+  void BeginObject(const std::string& strName = "") {
+    Open(strName, false);
+  }
+  void EndObject() { Close('}'); }
+
+  void BeginArray(const std::string& strName = "") {
+    Open(strName, true);
+  }
+  void EndArray() { Close(']'); }
+
+  void Value(const std::string& strName, const std::string& strValue) {
+    Write(strName, Quote(strValue), strValue);
+  }
+  void Value(const std::string& strName, const char* strValue) {
+    Value(strName, std::string(strValue));
+  }
+  void Value(const std::string& strName, bool bValue) {
+    Write(strName, bValue ? "true" : "false", bValue ? "true" : "false");
+  }
+  template<typename T>
+  void Value(const std::string& strName, T value) {
+    const std::string str = Number(value, std::is_integral<T>());
+    Write(strName, str, str);
+  }
+
+  // convenience for the (x,y,z) vectors of the UVF blocks
+  template<typename V>
+  void Vector3(const std::string& strName, const V& v) {
+    BeginArray(strName);
+    Value("", v.x);
+    Value("", v.y);
+    Value("", v.z);
+    EndArray();
+  }
+
+  void Flush() {
+    m_out.write(m_strBuffer.data(), std::streamsize(m_strBuffer.size()));
+    m_out.flush();
+    m_strBuffer.clear();
+  }
+
+private:
+  struct Level {
+    std::string strPath;
+    bool        bArray;
+    uint64_t    iCount;
+  };
+
+  std::ostream&      m_out;
+  EReportFormat      m_eFormat;
+  size_t             m_iFlushSize;
+  std::string        m_strBuffer;
+  std::vector<Level> m_Stack;
+
+  // arrays name their elements by index
+  std::string ChildName(const std::string& strName) const {
+    if (!m_Stack.empty() && m_Stack.back().bArray)
+      return std::to_string(m_Stack.back().iCount);
+    return strName;
+  }
+
+  void Separator(const std::string& strName) {
+    if (m_Stack.empty()) return;
+    if (m_Stack.back().iCount > 0) m_strBuffer += ",";
+    m_strBuffer += "\n";
+    m_strBuffer.append(2*m_Stack.size(), ' ');
+    if (!m_Stack.back().bArray) {
+      m_strBuffer += Quote(strName);
+      m_strBuffer += ": ";
+    }
+  }
+
+  void Open(const std::string& strName, bool bArray) {
+    Level l;
+    l.strPath = m_Stack.empty() ? strName
+                                : m_Stack.back().strPath + "/" +
+                                  ChildName(strName);
+    l.bArray = bArray;
+    l.iCount = 0;
+    if (m_eFormat == RF_JSON) {
+      Separator(strName);
+      m_strBuffer += bArray ? "[" : "{";
+    }
+    if (!m_Stack.empty()) m_Stack.back().iCount++;
+    m_Stack.push_back(l);
+  }
+
+  void Close(char cBracket) {
+    if (m_Stack.empty()) return;
+    const bool bEmpty = m_Stack.back().iCount == 0;
+    m_Stack.pop_back();
+    if (m_eFormat == RF_JSON) {
+      if (!bEmpty) {
+        m_strBuffer += "\n";
+        m_strBuffer.append(2*m_Stack.size(), ' ');
+      }
+      m_strBuffer += cBracket;
+      if (m_Stack.empty()) m_strBuffer += "\n";
+    }
+    if (m_strBuffer.size() >= m_iFlushSize) Flush();
+  }
+
+  void Write(const std::string& strName, const std::string& strJSON,
+             const std::string& strPlain) {
+    if (m_eFormat == RF_JSON) {
+      Separator(strName);
+      m_strBuffer += strJSON;
+    } else {
+      m_strBuffer += CSVField(m_Stack.empty() ? "" : m_Stack.back().strPath);
+      m_strBuffer += ",";
+      m_strBuffer += CSVField(ChildName(strName));
+      m_strBuffer += ",";
+      m_strBuffer += CSVField(strPlain);
+      m_strBuffer += "\n";
+    }
+    if (!m_Stack.empty()) m_Stack.back().iCount++;
+    if (m_strBuffer.size() >= m_iFlushSize) Flush();
+  }
+
+  template<typename T>
+  static std::string Number(T value, std::true_type) {
+    return std::is_signed<T>::value ? std::to_string((long long)value)
+                               : std::to_string((unsigned long long)value);
+  }
+
+  template<typename T>
+  static std::string Number(T value, std::false_type) {
+    // JSON has no representation for NaN and infinity
+    if (!std::isfinite(double(value))) return "null";
+    char buffer[32];
+    sprintf(buffer, "%.*g", std::numeric_limits<T>::digits10, double(value));
+    return buffer;
+  }
+
+  static std::string Quote(const std::string& str) {
+    std::string strQuoted = "\"";
+    for (size_t i = 0;i<str.size();i++) {
+      const unsigned char c = static_cast<unsigned char>(str[i]);
+      switch (c) {
+        case '"'  : strQuoted += "\\\""; break;
+        case '\\' : strQuoted += "\\\\"; break;
+        case '\n' : strQuoted += "\\n"; break;
+        case '\r' : strQuoted += "\\r"; break;
+        case '\t' : strQuoted += "\\t"; break;
+        default :
+          if (c < 0x20) {
+            char buffer[8];
+            sprintf(buffer, "\\u%04x", c);
+            strQuoted += buffer;
+          } else {
+            strQuoted += char(c);
+          }
+          break;
+      }
+    }
+    return strQuoted + "\"";
+  }
+
+  static std::string CSVField(const std::string& str) {
+    if (str.find_first_of(",\"\r\n") == std::string::npos) return str;
+    std::string strQuoted = "\"";
+    for (size_t i = 0;i<str.size();i++) {
+      if (str[i] == '"') strQuoted += '"';
+      strQuoted += str[i];
+    }
+    return strQuoted + "\"";
+  }
+};
+
+#endif // UVFREPORT_H
+
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2012 Interactive Visualization and Data Analysis Group
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
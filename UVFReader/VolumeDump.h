@@ -0,0 +1,404 @@
+#ifndef VOLUMEDUMP_H
+#define VOLUMEDUMP_H
+
+#include <string>
+#include <vector>
+#include <sstream>
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <limits>
+#include <cstdio>
+#include <cstdint>
+
+#include "../Tuvok/StdTuvokDefines.h"
+#include "../Tuvok/Basics/Vectors.h"
+#include "../Tuvok/Basics/LargeRAWFile.h"
+#include "../Tuvok/IO/UVF/UVF.h"
+#include "../Tuvok/IO/UVF/RasterDataBlock.h"
+#include "../Tuvok/IO/UVF/TOCBlock.h"
+
+#include "BrickTools.h"
+
+enum EDumpFormat {
+  DF_TEXT = 0,  // space separated values, one line per row of voxels
+  DF_RAW        // the voxels as they are in memory, x fastest
+};
+
+// Voxel range of one LoD. A size component of zero means "up to the end
+// of the volume"; larger sizes are clipped to the volume.
+struct DumpRegion {
+  UINT64VECTOR3 vOffset;
+  UINT64VECTOR3 vSize;
+};
+
+// Parses "x,y,z,width,height,depth".
+bool ParseDumpRegion(const std::string& strRegion, DumpRegion& region) {
+  std::string str = strRegion;
+  std::replace(str.begin(), str.end(), ',', ' ');
+  std::istringstream s(str);
+  s >> region.vOffset.x >> region.vOffset.y >> region.vOffset.z
+    >> region.vSize.x >> region.vSize.y >> region.vSize.z;
+  return !s.fail();
+}
+
+bool ClipDumpRegion(const UINT64VECTOR3& vDomain, DumpRegion& region,
+                    std::string& strProblem) {
+  for (size_t i = 0;i<3;i++) {
+    if (region.vOffset[i] >= vDomain[i]) {
+      strProblem = "region starts outside of the volume";
+      return false;
+    }
+    const uint64_t iLeft = vDomain[i] - region.vOffset[i];
+    if (region.vSize[i] == 0 || region.vSize[i] > iLeft)
+      region.vSize[i] = iLeft;
+  }
+  return true;
+}
+
+// Collects the dump in large pieces before they are handed to the stream,
+// numbers are converted without going through the stream formatting.
+class DumpWriter {
+public:
+  DumpWriter(std::ostream& out, EDumpFormat eFormat,
+             ExtendedOctree::COMPONENT_TYPE eType, size_t iFlushSize =
+             8*1024*1024) :
+    m_out(out),
+    m_eFormat(eFormat),
+    m_eType(eType),
+    m_iFlushSize(iFlushSize)
+  {
+    if (m_eFormat == DF_TEXT) m_strBuffer.reserve(iFlushSize + 4096);
+  }
+
+  ~DumpWriter() {
+    Flush();
+  }
+
+  // iRows consecutive rows of iRowValues values each
+  void WriteRows(const uint8_t* pData, size_t iRows, size_t iRowValues,
+                 size_t iValueSize) {
+    if (m_eFormat == DF_RAW) {
+      m_out.write(reinterpret_cast<const char*>(pData),
+                  std::streamsize(iRows * iRowValues * iValueSize));
+      return;
+    }
+    const size_t n = iRowValues;
+    for (size_t r = 0;r<iRows;r++) {
+      const uint8_t* pRow = pData + r * n * iValueSize;
+      switch (m_eType) {
+        case ExtendedOctree::CT_UINT8  : AppendRow<uint8_t>(pRow, n); break;
+        case ExtendedOctree::CT_INT8   : AppendRow<int8_t>(pRow, n); break;
+        case ExtendedOctree::CT_UINT16 : AppendRow<uint16_t>(pRow, n); break;
+        case ExtendedOctree::CT_INT16  : AppendRow<int16_t>(pRow, n); break;
+        case ExtendedOctree::CT_UINT32 : AppendRow<uint32_t>(pRow, n); break;
+        case ExtendedOctree::CT_INT32  : AppendRow<int32_t>(pRow, n); break;
+        case ExtendedOctree::CT_UINT64 : AppendRow<uint64_t>(pRow, n); break;
+        case ExtendedOctree::CT_INT64  : AppendRow<int64_t>(pRow, n); break;
+        case ExtendedOctree::CT_FLOAT32: AppendRow<float>(pRow, n); break;
+        case ExtendedOctree::CT_FLOAT64: AppendRow<double>(pRow, n); break;
+      }
+      if (m_strBuffer.size() >= m_iFlushSize) Flush();
+    }
+  }
+
+  void Flush() {
+    if (m_strBuffer.empty()) return;
+    m_out.write(m_strBuffer.data(), std::streamsize(m_strBuffer.size()));
+    m_strBuffer.clear();
+  }
+
+private:
+  std::ostream&                  m_out;
+  EDumpFormat                    m_eFormat;
+  ExtendedOctree::COMPONENT_TYPE m_eType;
+  size_t                         m_iFlushSize;
+  std::string                    m_strBuffer;
+
+  template<typename T>
+  void AppendRow(const uint8_t* pRow, size_t iValues) {
+    const T* p = reinterpret_cast<const T*>(pRow);
+    for (size_t i = 0;i<iValues;i++) {
+      if (i > 0) m_strBuffer += ' ';
+      Append(p[i]);
+    }
+    m_strBuffer += '\n';
+  }
+
+  void Append(uint64_t iValue) {
+    char buffer[24];
+    char* p = buffer + sizeof(buffer);
+    do {
+      *--p = char('0' + iValue % 10);
+      iValue /= 10;
+    } while (iValue);
+    m_strBuffer.append(p, buffer + sizeof(buffer) - p);
+  }
+  void Append(int64_t iValue) {
+    if (iValue < 0) {
+      m_strBuffer += '-';
+      Append(uint64_t(0) - uint64_t(iValue));
+    } else {
+      Append(uint64_t(iValue));
+    }
+  }
+  void Append(uint8_t v)  { Append(uint64_t(v)); }
+  void Append(uint16_t v) { Append(uint64_t(v)); }
+  void Append(uint32_t v) { Append(uint64_t(v)); }
+  void Append(int8_t v)   { Append(int64_t(v)); }
+  void Append(int16_t v)  { Append(int64_t(v)); }
+  void Append(int32_t v)  { Append(int64_t(v)); }
+  void Append(float v)    { AppendFloat(v, 9); }
+  void Append(double v)   { AppendFloat(v, 17); }
+
+  void AppendFloat(double v, int iDigits) {
+    // enough digits to read back the exact value
+    char buffer[32];
+    m_strBuffer.append(buffer, size_t(sprintf(buffer, "%.*g", iDigits, v)));
+  }
+};
+
+size_t ComponentTypeSize(ExtendedOctree::COMPONENT_TYPE eType) {
+  switch (eType) {
+    case ExtendedOctree::CT_UINT8  :
+    case ExtendedOctree::CT_INT8   : return 1;
+    case ExtendedOctree::CT_UINT16 :
+    case ExtendedOctree::CT_INT16  : return 2;
+    case ExtendedOctree::CT_UINT32 :
+    case ExtendedOctree::CT_INT32  :
+    case ExtendedOctree::CT_FLOAT32: return 4;
+    default                        : return 8;
+  }
+}
+
+// Writes a region of one LoD of a TOC block, one brick layer at a time:
+// the part of the region inside a layer is read with every brick of the
+// layer decompressed exactly once, then written in one piece. The buffer
+// thus holds region width x height x the inner brick depth.
+bool DumpTOCBlock(const TOCBlock* toc, uint64_t iLoD, DumpRegion region,
+                  EDumpFormat eFormat, std::ostream& out,
+                  std::string& strProblem) {
+  if (iLoD >= toc->GetLoDCount()) {
+    strProblem = "level of detail out of range";
+    return false;
+  }
+  if (!ClipDumpRegion(toc->GetLODDomainSize(iLoD), region, strProblem))
+    return false;
+
+  const ExtendedOctree::COMPONENT_TYPE eType = toc->GetComponentType();
+  const size_t iValueSize = ComponentTypeSize(eType);
+  const uint64_t iInnerZ = InnerBrickSize(toc).z;
+  const uint64_t iEndZ = region.vOffset.z + region.vSize.z;
+
+  DumpWriter writer(out, eFormat, eType);
+  std::vector<uint8_t> vLayer;
+  std::vector<uint8_t> vBrick;
+  for (uint64_t bz = region.vOffset.z / iInnerZ;bz<=(iEndZ - 1) / iInnerZ;
+       bz++) {
+    const uint64_t iLayerBegin = std::max(bz * iInnerZ, region.vOffset.z);
+    const uint64_t iLayerEnd = std::min((bz+1) * iInnerZ, iEndZ);
+    ReadTOCRegion(toc, iLoD,
+                  UINT64VECTOR3(region.vOffset.x, region.vOffset.y,
+                                iLayerBegin),
+                  UINT64VECTOR3(region.vSize.x, region.vSize.y,
+                                iLayerEnd - iLayerBegin),
+                  vBrick, vLayer);
+    writer.WriteRows(vLayer.data(),
+                     size_t((iLayerEnd - iLayerBegin) * region.vSize.y),
+                     size_t(region.vSize.x * toc->GetComponentCount()),
+                     iValueSize);
+  }
+  writer.Flush();
+  out.flush();
+  if (!out) {
+    strProblem = "writing the data failed";
+    return false;
+  }
+  return true;
+}
+
+bool RasterComponentType(const RasterDataBlock* b,
+                         ExtendedOctree::COMPONENT_TYPE& eType) {
+  const uint64_t iBits = b->ulElementBitSize[0][0];
+  const bool bSigned = b->bSignedElement[0][0];
+  if (iBits != b->ulElementMantissa[0][0]) {
+    if (iBits == 32) { eType = ExtendedOctree::CT_FLOAT32; return true; }
+    if (iBits == 64) { eType = ExtendedOctree::CT_FLOAT64; return true; }
+    return false;
+  }
+  switch (iBits) {
+    case 8  : eType = bSigned ? ExtendedOctree::CT_INT8
+                              : ExtendedOctree::CT_UINT8;  return true;
+    case 16 : eType = bSigned ? ExtendedOctree::CT_INT16
+                              : ExtendedOctree::CT_UINT16; return true;
+    case 32 : eType = bSigned ? ExtendedOctree::CT_INT32
+                              : ExtendedOctree::CT_UINT32; return true;
+    case 64 : eType = bSigned ? ExtendedOctree::CT_INT64
+                              : ExtendedOctree::CT_UINT64; return true;
+    default : return false;
+  }
+}
+
+// Writes a region of one LoD of a raster data block. The LoD is flattened
+// into strTempFile first, the region is then read from it slab by slab.
+bool DumpRasterBlock(const RasterDataBlock* b, uint64_t iLoD,
+                     DumpRegion region, EDumpFormat eFormat,
+                     std::ostream& out, const std::string& strTempFile,
+                     std::string& strProblem,
+                     uint64_t iMaxSlabBytes = 256*1024*1024) {
+  ExtendedOctree::COMPONENT_TYPE eType;
+  if (b->ulDomainSize.size() != 3 || b->ulElementBitSize.empty() ||
+      b->ulElementBitSize[0].size() != 1 || !RasterComponentType(b, eType)) {
+    strProblem = "only scalar three dimensional volumes can be written";
+    return false;
+  }
+  if (iLoD >= b->ulLODLevelCount[0]) {
+    strProblem = "level of detail out of range";
+    return false;
+  }
+  const std::vector<uint64_t> vLOD(1, iLoD);
+  const std::vector<uint64_t> vDomain = b->GetLODDomainSize(vLOD);
+  const UINT64VECTOR3 vSize(vDomain[0], vDomain[1], vDomain[2]);
+  if (!ClipDumpRegion(vSize, region, strProblem)) return false;
+
+  if (!b->BrickedLODToFlatData(vLOD, strTempFile)) {
+    // a partially written file must not stay behind
+    LargeRAWFile partial(strTempFile);
+    partial.Delete();
+    strProblem = "unable to write the temporary file " + strTempFile;
+    return false;
+  }
+  LargeRAWFile flat(strTempFile);
+  if (!flat.Open(false)) {
+    strProblem = "unable to read the temporary file " + strTempFile;
+    flat.Delete();
+    return false;
+  }
+
+  const size_t iVoxelSize = ComponentTypeSize(eType);
+  const uint64_t iSliceBytes = vSize.x * vSize.y * iVoxelSize;
+  const uint64_t iSlabSlices = std::max<uint64_t>(1,
+                                                  iMaxSlabBytes/iSliceBytes);
+  const size_t iRowBytes = size_t(region.vSize.x * iVoxelSize);
+
+  DumpWriter writer(out, eFormat, eType);
+  std::vector<uint8_t> vSlab;
+  std::vector<uint8_t> vRegion;
+  for (uint64_t z0 = region.vOffset.z;
+       z0<region.vOffset.z + region.vSize.z;z0 += iSlabSlices) {
+    const uint64_t z1 = std::min(z0 + iSlabSlices,
+                                 region.vOffset.z + region.vSize.z);
+    // one read per slab, covering the rows of the region in every slice
+    const uint64_t iFirstRow = region.vOffset.y;
+    const uint64_t iRows = (z1 - z0 - 1) * vSize.y + region.vSize.y;
+    vSlab.resize(size_t(iRows * vSize.x * iVoxelSize));
+    flat.SeekPos((z0 * vSize.y + iFirstRow) * vSize.x * iVoxelSize);
+    if (flat.ReadRAW(vSlab.data(), vSlab.size()) != vSlab.size()) {
+      strProblem = "reading the temporary file failed";
+      flat.Close();
+      flat.Delete();
+      return false;
+    }
+
+    vRegion.resize(size_t((z1 - z0) * region.vSize.y) * iRowBytes);
+    size_t iTarget = 0;
+    for (uint64_t z = 0;z<z1 - z0;z++) {
+      for (uint64_t y = 0;y<region.vSize.y;y++) {
+        const uint64_t iSource = ((z * vSize.y + y) * vSize.x +
+                                  region.vOffset.x) * iVoxelSize;
+        std::copy(vSlab.begin() + size_t(iSource),
+                  vSlab.begin() + size_t(iSource) + iRowBytes,
+                  vRegion.begin() + iTarget);
+        iTarget += iRowBytes;
+      }
+    }
+    writer.WriteRows(vRegion.data(), size_t((z1 - z0) * region.vSize.y),
+                     size_t(region.vSize.x), iVoxelSize);
+  }
+  flat.Close();
+  flat.Delete();
+
+  writer.Flush();
+  out.flush();
+  if (!out) {
+    strProblem = "writing the data failed";
+    return false;
+  }
+  return true;
+}
+
+// Writes a region of one LoD of the first volume in a UVF file to
+// strTarget, or to stdout if strTarget is "-".
+bool DumpVolume(const std::string& strUVFName, uint64_t iLoD,
+                const DumpRegion& region, EDumpFormat eFormat,
+                const std::string& strTarget, std::string& strProblem) {
+  const std::wstring wstrUVFName(strUVFName.begin(), strUVFName.end());
+  UVF uvfFile(wstrUVFName);
+  if (!uvfFile.Open(false, false, false, &strProblem)) return false;
+
+  const DataBlock* volume = NULL;
+  for (uint64_t i = 0;i<uvfFile.GetDataBlockCount() && !volume;i++) {
+    const DataBlock* b = uvfFile.GetDataBlock(i).get();
+    if (b->GetBlockSemantic() == UVFTables::BS_TOC_BLOCK ||
+        b->GetBlockSemantic() == UVFTables::BS_REG_NDIM_GRID)
+      volume = b;
+  }
+  if (!volume) {
+    strProblem = "file contains no volume";
+    uvfFile.Close();
+    return false;
+  }
+
+  std::ofstream file;
+  if (strTarget != "-") {
+    file.open(strTarget.c_str(), eFormat == DF_RAW
+                                 ? std::ios::out | std::ios::binary
+                                 : std::ios::out);
+    if (!file) {
+      strProblem = "unable to create " + strTarget;
+      uvfFile.Close();
+      return false;
+    }
+  }
+  std::ostream& out = strTarget != "-" ? file : std::cout;
+
+  bool bResult;
+  if (volume->GetBlockSemantic() == UVFTables::BS_TOC_BLOCK)
+    bResult = DumpTOCBlock(dynamic_cast<const TOCBlock*>(volume), iLoD,
+                           region, eFormat, out, strProblem);
+  else
+    bResult = DumpRasterBlock(dynamic_cast<const RasterDataBlock*>(volume),
+                              iLoD, region, eFormat, out,
+                              TemporaryFileName(strUVFName, "flat.tmp"),
+                              strProblem);
+  uvfFile.Close();
+  return bResult;
+}
+
+#endif // VOLUMEDUMP_H
+
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2012 Interactive Visualization and Data Analysis Group
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
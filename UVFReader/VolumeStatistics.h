@@ -0,0 +1,571 @@
+#ifndef VOLUMESTATISTICS_H
+#define VOLUMESTATISTICS_H
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <algorithm>
+#include <limits>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+
+#include "../Tuvok/StdTuvokDefines.h"
+#include "../Tuvok/Basics/SysTools.h"
+#include "../Tuvok/Basics/Vectors.h"
+#include "../Tuvok/Basics/LargeRAWFile.h"
+#include "../Tuvok/IO/UVF/UVF.h"
+#include "../Tuvok/IO/UVF/RasterDataBlock.h"
+#include "../Tuvok/IO/UVF/TOCBlock.h"
+#include "../Tuvok/IO/UVF/KeyValuePairDataBlock.h"
+
+#include "ParallelTools.h"
+#include "BrickTools.h"
+#include "VolumeDump.h"
+#include "UVFReport.h"
+
+// Mergeable streaming quantile sketch. Level i holds values that stand for
+// 2^i input values each; a full level is sorted and every other value
+// moves up one level, so memory stays at about iCapacity values per level
+// and the rank error at about (level count)/iCapacity.
+class QuantileSketch {
+public:
+  explicit QuantileSketch(size_t iCapacity = 4096) :
+    m_iCapacity(iCapacity),
+    m_bOddHalf(false)
+  {}
+
+  void Add(double fValue) {
+    if (m_Levels.empty()) m_Levels.resize(1);
+    m_Levels[0].push_back(fValue);
+    if (m_Levels[0].size() >= m_iCapacity) Compact(0);
+  }
+
+  void Merge(const QuantileSketch& other) {
+    if (m_Levels.size() < other.m_Levels.size())
+      m_Levels.resize(other.m_Levels.size());
+    for (size_t l = 0;l<other.m_Levels.size();l++)
+      m_Levels[l].insert(m_Levels[l].end(), other.m_Levels[l].begin(),
+                         other.m_Levels[l].end());
+    for (size_t l = 0;l<m_Levels.size();l++)
+      if (m_Levels[l].size() >= m_iCapacity) Compact(l);
+  }
+
+  // value below which a fraction q of all added values lies
+  double Quantile(double q) const {
+    std::vector<std::pair<double, uint64_t>> vWeighted;
+    uint64_t iTotal = 0;
+    for (size_t l = 0;l<m_Levels.size();l++) {
+      for (size_t i = 0;i<m_Levels[l].size();i++)
+        vWeighted.push_back(std::make_pair(m_Levels[l][i],
+                                           uint64_t(1) << l));
+      iTotal += m_Levels[l].size() << l;
+    }
+    if (vWeighted.empty()) return 0.0;
+    std::sort(vWeighted.begin(), vWeighted.end());
+    const double fRank = q * double(iTotal);
+    uint64_t iSeen = 0;
+    for (size_t i = 0;i<vWeighted.size();i++) {
+      iSeen += vWeighted[i].second;
+      if (double(iSeen) >= fRank) return vWeighted[i].first;
+    }
+    return vWeighted.back().first;
+  }
+
+private:
+  size_t m_iCapacity;
+  bool   m_bOddHalf;
+  std::vector<std::vector<double>> m_Levels;
+
+  void Compact(size_t iLevel) {
+    if (m_Levels.size() == iLevel+1) m_Levels.resize(iLevel+2);
+    std::vector<double>& v = m_Levels[iLevel];
+    std::sort(v.begin(), v.end());
+    // an odd value out stays behind, so no weight is lost
+    const size_t iPairs = v.size() / 2;
+    // alternating between the even and odd half keeps the error unbiased
+    const size_t iStart = m_bOddHalf ? 1 : 0;
+    m_bOddHalf = !m_bOddHalf;
+    for (size_t i = 0;i<iPairs;i++)
+      m_Levels[iLevel+1].push_back(v[2*i + iStart]);
+    v.erase(v.begin(), v.begin() + 2*iPairs);
+    if (m_Levels[iLevel+1].size() >= m_iCapacity) Compact(iLevel+1);
+  }
+};
+
+static const size_t PERCENTILE_COUNT = 7;
+static const double PERCENTILES[PERCENTILE_COUNT] = {
+  1, 5, 25, 50, 75, 95, 99
+};
+
+// Statistics of one component over the whole volume.
+struct ValueStatistics {
+  uint64_t iCount;
+  double   fMin;
+  double   fMax;
+  double   fMean;
+  double   fStdDev;
+  double   fZeroFraction;
+  double   fPercentiles[PERCENTILE_COUNT];  // see PERCENTILES
+  bool     bExactPercentiles;
+};
+
+// Per thread accumulator for one component. Every run of values (a row of
+// a brick) is summarized on its own and then merged with the parallel form
+// of Welford's algorithm (Chan et al.), which also merges the threads.
+// 8 and 16 bit integers are counted exactly, anything else goes through
+// the quantile sketch.
+class ValueAccumulator {
+public:
+  explicit ValueAccumulator(ExtendedOctree::COMPONENT_TYPE eType) :
+    m_iCount(0),
+    m_iZeros(0),
+    m_fMin(std::numeric_limits<double>::max()),
+    m_fMax(-std::numeric_limits<double>::max()),
+    m_fMean(0.0),
+    m_fM2(0.0)
+  {
+    switch (eType) {
+      case ExtendedOctree::CT_UINT8  : m_iHistogramBias = 0;     break;
+      case ExtendedOctree::CT_INT8   : m_iHistogramBias = 128;   break;
+      case ExtendedOctree::CT_UINT16 : m_iHistogramBias = 0;     break;
+      case ExtendedOctree::CT_INT16  : m_iHistogramBias = 32768; break;
+      default                        : m_iHistogramBias = -1;    break;
+    }
+    if (m_iHistogramBias >= 0)
+      m_vHistogram.resize(ComponentTypeSize(eType) == 1 ? 256 : 65536);
+  }
+
+  // adds iCount values, iStride elements apart
+  template<typename T>
+  void AddValues(const T* p, size_t iCount, size_t iStride) {
+    if (iCount == 0) return;
+    double fSum = 0.0;
+    double fMin = double(p[0]);
+    double fMax = double(p[0]);
+    uint64_t iZeros = 0;
+    for (size_t i = 0;i<iCount;i++) {
+      const T v = p[i*iStride];
+      const double f = double(v);
+      fSum += f;
+      fMin = std::min(fMin, f);
+      fMax = std::max(fMax, f);
+      if (v == T(0)) iZeros++;
+      if (m_iHistogramBias >= 0)
+        m_vHistogram[size_t(int64_t(v) + m_iHistogramBias)]++;
+      else
+        m_Sketch.Add(f);
+    }
+    // second pass while the values are still in the cache
+    const double fMean = fSum / double(iCount);
+    double fM2 = 0.0;
+    for (size_t i = 0;i<iCount;i++) {
+      const double d = double(p[i*iStride]) - fMean;
+      fM2 += d*d;
+    }
+    Merge(iCount, iZeros, fMin, fMax, fMean, fM2);
+  }
+
+  void Merge(const ValueAccumulator& other) {
+    Merge(other.m_iCount, other.m_iZeros, other.m_fMin, other.m_fMax,
+          other.m_fMean, other.m_fM2);
+    for (size_t i = 0;i<m_vHistogram.size();i++)
+      m_vHistogram[i] += other.m_vHistogram[i];
+    m_Sketch.Merge(other.m_Sketch);
+  }
+
+  ValueStatistics Result() const {
+    ValueStatistics s;
+    s.iCount = m_iCount;
+    s.fMin = m_iCount ? m_fMin : 0.0;
+    s.fMax = m_iCount ? m_fMax : 0.0;
+    s.fMean = m_fMean;
+    s.fStdDev = m_iCount ? sqrt(m_fM2 / double(m_iCount)) : 0.0;
+    s.fZeroFraction = m_iCount ? double(m_iZeros) / double(m_iCount) : 0.0;
+    s.bExactPercentiles = m_iHistogramBias >= 0;
+    for (size_t i = 0;i<PERCENTILE_COUNT;i++)
+      s.fPercentiles[i] = Quantile(PERCENTILES[i] / 100.0);
+    return s;
+  }
+
+private:
+  uint64_t m_iCount;
+  uint64_t m_iZeros;
+  double   m_fMin;
+  double   m_fMax;
+  double   m_fMean;
+  double   m_fM2;
+  int64_t  m_iHistogramBias;  // -1 if the sketch is used
+  std::vector<uint64_t> m_vHistogram;
+  QuantileSketch m_Sketch;
+
+  void Merge(uint64_t iCount, uint64_t iZeros, double fMin, double fMax,
+             double fMean, double fM2) {
+    if (iCount == 0) return;
+    const double n = double(m_iCount + iCount);
+    const double fDelta = fMean - m_fMean;
+    m_fM2 += fM2 + fDelta*fDelta * double(m_iCount) * double(iCount) / n;
+    m_fMean += fDelta * double(iCount) / n;
+    m_iCount += iCount;
+    m_iZeros += iZeros;
+    m_fMin = std::min(m_fMin, fMin);
+    m_fMax = std::max(m_fMax, fMax);
+  }
+
+  double Quantile(double q) const {
+    if (m_iHistogramBias < 0) return m_Sketch.Quantile(q);
+    const double fRank = q * double(m_iCount);
+    uint64_t iSeen = 0;
+    for (size_t i = 0;i<m_vHistogram.size();i++) {
+      iSeen += m_vHistogram[i];
+      if (iSeen > 0 && double(iSeen) >= fRank)
+        return double(int64_t(i) - m_iHistogramBias);
+    }
+    return m_fMax;
+  }
+};
+
+// Adds the values of iVoxels voxels with iComponents interleaved
+// components to one accumulator per component.
+void AccumulateVoxels(ExtendedOctree::COMPONENT_TYPE eType,
+                      const uint8_t* pData, size_t iVoxels,
+                      size_t iComponents,
+                      std::vector<ValueAccumulator>& vAcc) {
+  for (size_t c = 0;c<iComponents;c++) {
+    switch (eType) {
+#define ACCUMULATE(CT, T)                                                   \
+      case ExtendedOctree::CT :                                             \
+        vAcc[c].AddValues(reinterpret_cast<const T*>(pData) + c, iVoxels,   \
+                          iComponents);                                     \
+        break;
+      ACCUMULATE(CT_UINT8,   uint8_t)
+      ACCUMULATE(CT_INT8,    int8_t)
+      ACCUMULATE(CT_UINT16,  uint16_t)
+      ACCUMULATE(CT_INT16,   int16_t)
+      ACCUMULATE(CT_UINT32,  uint32_t)
+      ACCUMULATE(CT_INT32,   int32_t)
+      ACCUMULATE(CT_UINT64,  uint64_t)
+      ACCUMULATE(CT_INT64,   int64_t)
+      ACCUMULATE(CT_FLOAT32, float)
+      ACCUMULATE(CT_FLOAT64, double)
+#undef ACCUMULATE
+    }
+  }
+}
+
+// Adds the brick without its overlap, so every voxel is counted once.
+void AccumulateBrick(const TOCBlock* toc, const UINT64VECTOR4& key,
+                     const std::vector<uint8_t>& data,
+                     std::vector<ValueAccumulator>& vAcc) {
+  const UINT64VECTOR3 vSize = toc->GetBrickSize(key);
+  const uint64_t iOverlap = toc->GetOverlap();
+  const size_t iComponents = size_t(toc->GetComponentCount());
+  const size_t iVoxelSize = iComponents *
+                            size_t(toc->GetComponentTypeSize());
+  const size_t iRowVoxels = size_t(vSize.x - 2*iOverlap);
+  for (uint64_t z = iOverlap;z<vSize.z - iOverlap;z++)
+    for (uint64_t y = iOverlap;y<vSize.y - iOverlap;y++)
+      AccumulateVoxels(toc->GetComponentType(),
+                       data.data() + size_t(((z * vSize.y + y) * vSize.x +
+                                              iOverlap) * iVoxelSize),
+                       iRowVoxels, iComponents, vAcc);
+}
+
+std::vector<ValueStatistics>
+MergeStatistics(ExtendedOctree::COMPONENT_TYPE eType, size_t iComponents,
+                const std::vector<std::vector<ValueAccumulator>>& vWorker) {
+  std::vector<ValueAccumulator> vTotal(iComponents,
+                                       ValueAccumulator(eType));
+  for (size_t w = 0;w<vWorker.size();w++)
+    for (size_t c = 0;c<iComponents;c++) vTotal[c].Merge(vWorker[w][c]);
+  std::vector<ValueStatistics> vResult;
+  for (size_t c = 0;c<iComponents;c++)
+    vResult.push_back(vTotal[c].Result());
+  return vResult;
+}
+
+// Statistics of the finest LoD of a raster data block, flattened into
+// strTempFile and read back in parallel slabs.
+bool ComputeRasterStatistics(const RasterDataBlock* b,
+                             const std::string& strTempFile,
+                             unsigned int iWorkers,
+                             std::vector<ValueStatistics>& vResult,
+                             std::string& strProblem) {
+  ExtendedOctree::COMPONENT_TYPE eType;
+  if (b->ulElementBitSize.empty() || b->ulElementBitSize[0].size() != 1 ||
+      !RasterComponentType(b, eType)) {
+    strProblem = "only scalar volumes are supported";
+    return false;
+  }
+  const std::vector<uint64_t> vLOD(1, 0);
+  if (!b->BrickedLODToFlatData(vLOD, strTempFile)) {
+    // a partially written file must not stay behind
+    LargeRAWFile partial(strTempFile);
+    partial.Delete();
+    strProblem = "unable to write the temporary file " + strTempFile;
+    return false;
+  }
+
+  const uint64_t iValueSize = ComponentTypeSize(eType);
+  const uint64_t iSlabSize = (16*1024*1024) / iValueSize;
+  uint64_t iValues = 0;
+  {
+    LargeRAWFile flat(strTempFile);
+    if (!flat.Open(false)) {
+      strProblem = "unable to read the temporary file " + strTempFile;
+      flat.Delete();
+      return false;
+    }
+    iValues = flat.GetCurrentSize() / iValueSize;
+    flat.Close();
+  }
+  const uint64_t iSlabs = (iValues + iSlabSize - 1) / iSlabSize;
+  iWorkers = std::max(1u, iWorkers);
+
+  std::vector<std::vector<ValueAccumulator>> vWorker(
+    iWorkers, std::vector<ValueAccumulator>(1, ValueAccumulator(eType)));
+  std::atomic<uint64_t> iNext(0);
+  std::atomic<bool> bFailed(false);
+  std::vector<std::thread> threads;
+  for (unsigned int t = 0;t<iWorkers;t++) {
+    threads.push_back(std::thread([&, t]() {
+      LargeRAWFile flat(strTempFile);
+      if (!flat.Open(false)) {
+        bFailed = true;
+        return;
+      }
+      std::vector<uint8_t> data;
+      for (uint64_t i = iNext++;i<iSlabs && !bFailed;i = iNext++) {
+        const uint64_t iCount = std::min(iSlabSize, iValues - i*iSlabSize);
+        data.resize(size_t(iCount * iValueSize));
+        flat.SeekPos(i * iSlabSize * iValueSize);
+        if (flat.ReadRAW(data.data(), data.size()) != data.size()) {
+          bFailed = true;
+          break;
+        }
+        AccumulateVoxels(eType, data.data(), size_t(iCount), 1, vWorker[t]);
+      }
+      flat.Close();
+    }));
+  }
+  for (size_t t = 0;t<threads.size();t++) threads[t].join();
+
+  LargeRAWFile flat(strTempFile);
+  flat.Delete();
+  if (bFailed) {
+    strProblem = "reading the temporary file failed";
+    return false;
+  }
+  vResult = MergeStatistics(eType, 1, vWorker);
+  return true;
+}
+
+// Stored statistics live in a key value block with this ID, with the keys
+// "<component> <name>", e.g. "0 mean" or "0 p99".
+static const char* const STATISTICS_BLOCK_ID = "Value Statistics";
+
+std::string StatisticsNumber(double f) {
+  char buffer[32];
+  sprintf(buffer, "%.17g", f);
+  return buffer;
+}
+
+std::shared_ptr<KeyValuePairDataBlock>
+StatisticsToKVP(const std::vector<ValueStatistics>& vStats) {
+  std::shared_ptr<KeyValuePairDataBlock> kvp(new KeyValuePairDataBlock());
+  kvp->strBlockID = STATISTICS_BLOCK_ID;
+  for (size_t c = 0;c<vStats.size();c++) {
+    const ValueStatistics& s = vStats[c];
+    const std::string strPrefix = SysTools::ToString(c) + " ";
+    kvp->AddPair(strPrefix + "count", SysTools::ToString(s.iCount));
+    kvp->AddPair(strPrefix + "min", StatisticsNumber(s.fMin));
+    kvp->AddPair(strPrefix + "max", StatisticsNumber(s.fMax));
+    kvp->AddPair(strPrefix + "mean", StatisticsNumber(s.fMean));
+    kvp->AddPair(strPrefix + "stddev", StatisticsNumber(s.fStdDev));
+    kvp->AddPair(strPrefix + "zero fraction",
+                 StatisticsNumber(s.fZeroFraction));
+    kvp->AddPair(strPrefix + "exact percentiles",
+                 s.bExactPercentiles ? "true" : "false");
+    for (size_t i = 0;i<PERCENTILE_COUNT;i++)
+      kvp->AddPair(strPrefix + "p" + SysTools::ToString(PERCENTILES[i]),
+                   StatisticsNumber(s.fPercentiles[i]));
+  }
+  return kvp;
+}
+
+bool StatisticsFromKVP(const KeyValuePairDataBlock* kvp,
+                       std::vector<ValueStatistics>& vStats) {
+  vStats.clear();
+  for (size_t c = 0;;c++) {
+    const std::string strPrefix = SysTools::ToString(c) + " ";
+    if (kvp->GetIndexForKey(strPrefix + "count") < 0) break;
+
+    bool bComplete = true;
+    auto value = [&](const std::string& strName) {
+      const int64_t i = kvp->GetIndexForKey(strPrefix + strName);
+      if (i < 0) {
+        bComplete = false;
+        return std::string("0");
+      }
+      return kvp->GetValueByIndex(size_t(i));
+    };
+    ValueStatistics s;
+    s.iCount = strtoull(value("count").c_str(), NULL, 10);
+    s.fMin = atof(value("min").c_str());
+    s.fMax = atof(value("max").c_str());
+    s.fMean = atof(value("mean").c_str());
+    s.fStdDev = atof(value("stddev").c_str());
+    s.fZeroFraction = atof(value("zero fraction").c_str());
+    s.bExactPercentiles = value("exact percentiles") == "true";
+    for (size_t i = 0;i<PERCENTILE_COUNT;i++)
+      s.fPercentiles[i] =
+        atof(value("p" + SysTools::ToString(PERCENTILES[i])).c_str());
+    if (!bComplete) return false;
+    vStats.push_back(s);
+  }
+  return !vStats.empty();
+}
+
+// Statistics of the first volume of a UVF file. Stored statistics are
+// used if the file has them, otherwise every brick of the finest LoD is
+// read once on iWorkers threads.
+bool VolumeStatistics(const std::string& strUVFName, unsigned int iWorkers,
+                      std::vector<ValueStatistics>& vStats, bool& bStored,
+                      std::string& strProblem) {
+  const std::wstring wstrUVFName(strUVFName.begin(), strUVFName.end());
+  UVF uvfFile(wstrUVFName);
+  if (!uvfFile.Open(false, false, false, &strProblem)) return false;
+
+  const DataBlock* volume = NULL;
+  for (uint64_t i = 0;i<uvfFile.GetDataBlockCount();i++) {
+    const DataBlock* b = uvfFile.GetDataBlock(i).get();
+    if (b->GetBlockSemantic() == UVFTables::BS_KEY_VALUE_PAIRS &&
+        b->strBlockID == STATISTICS_BLOCK_ID &&
+        StatisticsFromKVP(dynamic_cast<const KeyValuePairDataBlock*>(b),
+                          vStats)) {
+      bStored = true;
+      uvfFile.Close();
+      return true;
+    }
+    if (!volume && (b->GetBlockSemantic() == UVFTables::BS_TOC_BLOCK ||
+                    b->GetBlockSemantic() == UVFTables::BS_REG_NDIM_GRID))
+      volume = b;
+  }
+  bStored = false;
+  if (!volume) {
+    strProblem = "file contains no volume";
+    uvfFile.Close();
+    return false;
+  }
+
+  if (volume->GetBlockSemantic() == UVFTables::BS_REG_NDIM_GRID) {
+    const bool bResult = ComputeRasterStatistics(
+      dynamic_cast<const RasterDataBlock*>(volume),
+      TemporaryFileName(strUVFName, "flat.tmp"), iWorkers, vStats,
+      strProblem);
+    uvfFile.Close();
+    return bResult;
+  }
+
+  const TOCBlock* toc = dynamic_cast<const TOCBlock*>(volume);
+  const ExtendedOctree::COMPONENT_TYPE eType = toc->GetComponentType();
+  const size_t iComponents = size_t(toc->GetComponentCount());
+  const std::vector<UINT64VECTOR4> vBricks = LoDBricks(toc, 0);
+  uvfFile.Close();
+
+  // every worker reads through its own file handle
+  iWorkers = std::max(1u, iWorkers);
+  std::vector<std::vector<ValueAccumulator>> vWorker(
+    iWorkers, std::vector<ValueAccumulator>(iComponents,
+                                            ValueAccumulator(eType)));
+  if (!ForEachBrick(strUVFName, vBricks, iWorkers,
+                    [&](unsigned int iWorker, size_t i,
+                        const TOCBlock* workerToc,
+                        const std::vector<uint8_t>& data) {
+                      AccumulateBrick(workerToc, vBricks[i], data,
+                                      vWorker[iWorker]);
+                    }, strProblem))
+    return false;
+  vStats = MergeStatistics(eType, iComponents, vWorker);
+  return true;
+}
+
+void PrintStatistics(const std::string& strUVFName,
+                     const std::vector<ValueStatistics>& vStats,
+                     bool bStored, std::ostream& out) {
+  out << "Statistics of " << strUVFName
+      << (bStored ? " (stored in the file)" : "") << "\n";
+  for (size_t c = 0;c<vStats.size();c++) {
+    const ValueStatistics& s = vStats[c];
+    out << "  Component " << c << ": " << s.iCount << " values\n"
+        << "    Range: " << s.fMin << " to " << s.fMax << "\n"
+        << "    Mean: " << s.fMean << ", standard deviation: "
+        << s.fStdDev << "\n"
+        << "    Zero fraction: " << s.fZeroFraction << "\n"
+        << "    Percentiles" << (s.bExactPercentiles ? "" : " (estimated)")
+        << ":";
+    for (size_t i = 0;i<PERCENTILE_COUNT;i++)
+      out << " p" << PERCENTILES[i] << "=" << s.fPercentiles[i];
+    out << "\n";
+  }
+  out.flush();
+}
+
+void ReportStatistics(const std::string& strUVFName,
+                      const std::vector<ValueStatistics>& vStats,
+                      bool bStored, ReportWriter& r) {
+  r.BeginObject(strUVFName);
+  r.Value("file", strUVFName);
+  r.Value("stored", bStored);
+  r.BeginArray("components");
+  for (size_t c = 0;c<vStats.size();c++) {
+    const ValueStatistics& s = vStats[c];
+    r.BeginObject();
+    r.Value("count", s.iCount);
+    r.Value("min", s.fMin);
+    r.Value("max", s.fMax);
+    r.Value("mean", s.fMean);
+    r.Value("stddev", s.fStdDev);
+    r.Value("zero_fraction", s.fZeroFraction);
+    r.Value("exact_percentiles", s.bExactPercentiles);
+    r.BeginObject("percentiles");
+    for (size_t i = 0;i<PERCENTILE_COUNT;i++)
+      r.Value("p" + SysTools::ToString(PERCENTILES[i]), s.fPercentiles[i]);
+    r.EndObject();
+    r.EndObject();
+  }
+  r.EndArray();
+  r.EndObject();
+}
+
+#endif // VOLUMESTATISTICS_H
+
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2012 Interactive Visualization and Data Analysis Group
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
@@ -7,12 +7,26 @@
 
 #include "DataSource.h"
 #include "BlockInfo.h"
+#include "BrickBenchmark.h"
+#include "AccessSimulator.h"
+#include "VolumeDump.h"
+#include "VolumeStatistics.h"
+#include "UVFHeaders.h"
+#include "UVFCompare.h"
 #include "Basics/SystemInfo.h"
 
 using namespace boost;
 using namespace std;
 using namespace tuvok;
 
+enum {
+  EXIT_FAILURE_ARG = 1,       // invalid argument
+  EXIT_FAILURE_CREATE,        // error during file creation
+  EXIT_FAILURE_READ,          // some files could not be read or verified
+  EXIT_FAILURE_READ_ALL,      // none of the files could be read or verified
+  EXIT_FAILURE_DIFFERENT,     // the compared volumes differ
+};
+
 #ifdef _WIN32
   // CRT's memory leak detection
   #if defined(DEBUG) || defined(_DEBUG)
@@ -38,7 +52,7 @@ int main(int argc, char* argv[])
     #endif
   #endif
 
-  string strUVFName = "";
+  vector<string> vUVFNames;
 
   uint32_t iSizeX = 100;
   uint32_t iSizeY = 200;
@@ -46,12 +60,18 @@ int main(int argc, char* argv[])
   uint32_t iBitSize = 8;
   uint32_t iBrickSize = DEFAULT_BRICKSIZE;
   uint32_t iIter = 0;
+  uint64_t iSeed = 0;
+  double fFrequency = 8.0;
+  double fSparsity = 0.5;
   uint32_t iMem = 0;
+  uint32_t iJobs = 0;
   uint32_t iBrickLayout = 0; // 0 is default scanline layout
   uint32_t iCompression = 1; // 1 is default zlib compression
   uint32_t iCompressionLevel = 1; // generic compression level, 1 is best speed
+  bool bFloat;
   bool bCreateFile;
   bool bhierarchical;
+  bool bFastFractal;
   bool bVerify;
   bool bShow1dhist;
   bool bShow2dhist;
@@ -59,10 +79,32 @@ int main(int argc, char* argv[])
   bool bShowData;
   bool bUseToCBlock;
   bool bKeepRaw;
+  bool bDirectToBrick;
+  bool bBrickChecksums;
+  bool bStoreStatistics;
+  bool bStatistics;
+  bool bHeaders;
+  bool bCompare;
+  uint64_t iCompareDiffs = 10;
+  bool bVerifyBricks;
+  bool bScanBricks;
+  bool bBenchmark;
+  uint64_t iBenchLoD = 0;
+  uint64_t iBenchSample = 0;
+  bool bSimulate;
+  bool bReplay;
+  uint64_t iSimLoD = 0;
+  uint64_t iSimViews = 8;
+  std::string strDumpTarget;
+  uint64_t iDumpLoD = 0;
+  DumpRegion dumpRegion = {UINT64VECTOR3(0, 0, 0), UINT64VECTOR3(0, 0, 0)};
+  bool bDumpRaw;
+  EReportFormat eReportFormat = RF_TEXT;
 
   try {
     TCLAP::CmdLine cmd("UVF diagnostic and demo data generation tool");
-    TCLAP::MultiArg<std::string> inputs("f", "file", "input/output file.",
+    TCLAP::MultiArg<std::string> inputs("f", "file", "input/output file, "
+                                        "may be given several times",
                                         true, "filename");
     TCLAP::SwitchArg noverify("n", "noverify", "disable the checksum test",
                               false);
@@ -71,17 +113,38 @@ int main(int argc, char* argv[])
     TCLAP::SwitchArg create("c", "create", "create instead of read a UVF",
                             false);
     TCLAP::ValueArg<uint32_t> ctype("t", "creation-type", "What type of volume to "
-                                    "create. 0: mandelbulb fractal, 1: all zeros,"
-                                    "2: random values, otherwise create a sphere",
+                                    "create. 0: mandelbulb fractal, 1: all zeros, "
+                                    "2: random values, 3: sphere, 4: gradient "
+                                    "noise, 5: CT phantom, 6: particle blobs, "
+                                    "7: anisotropic gradient field",
                                     false, static_cast<uint32_t>(3),
                                 "volume type class");
     TCLAP::SwitchArg hierarchical("g", "hierarchical", "hierarchical generation mode", false);
+    TCLAP::SwitchArg fastfractal("", "fast-fractal", "use the vectorized, "
+                                 "trig-free fractal kernel (iteration counts "
+                                 "may differ slightly from the default kernel)",
+                                 false);
     std::string uint = "unsigned integer";
     TCLAP::SwitchArg output_data("d", "data", "display data at finest"
                                  " resolution", false);
     TCLAP::ValueArg<uint32_t> iter("i", "iterations", "number of iterations "
                                    "for fractal compuation", false, 
                                    static_cast<uint32_t>(0), uint);
+    TCLAP::ValueArg<uint64_t> seed("", "seed", "seed for random volumes, "
+                                   "the same seed always creates the same "
+                                   "data", false, static_cast<uint64_t>(0),
+                                   uint);
+    TCLAP::ValueArg<double> frequency("", "frequency", "feature count along "
+                                      "one axis of the synthetic volumes "
+                                      "(types 4 to 7)", false, 8.0, "number");
+    TCLAP::ValueArg<double> sparsity("", "sparsity", "fraction of the "
+                                     "synthetic volumes (types 4 to 7) that "
+                                     "is left empty, between 0 and 1", false,
+                                     0.5, "number");
+    TCLAP::ValueArg<uint32_t> jobs("j", "jobs", "number of files to read "
+                                   "concurrently or of benchmark threads, "
+                                   "0: one per CPU core",
+                                   false, static_cast<uint32_t>(0), uint);
     TCLAP::ValueArg<uint32_t> mem("e", "memory", "gigabytes of memory "
                                    "to be used for UVF creation", false, 
                                    static_cast<uint32_t>(0), uint);
@@ -98,8 +161,13 @@ int main(int argc, char* argv[])
                                   false, static_cast<size_t>(200), uint);
     TCLAP::ValueArg<size_t> sizeZ("z", "sizeZ", "depth of created volume",
                                   false, static_cast<size_t>(300), uint);
-    TCLAP::ValueArg<size_t> bits("b", "bits", "bit width of created volume",
+    TCLAP::ValueArg<size_t> bits("b", "bits", "bit width of created volume, "
+                                 "8, 16 or 32 for integers, 16 (raw files "
+                                 "only), 32 or 64 for floats",
                                  false, static_cast<size_t>(8), uint);
+    TCLAP::SwitchArg floatdata("", "float", "create floating point data "
+                               "(normalized to [0,1]) instead of integers",
+                               false);
     TCLAP::ValueArg<size_t> bsize("s", "bricksize", "maximum width, "
                                   "in any dimension, for a created volume",
                                   false, static_cast<size_t>(256), uint);
@@ -110,6 +178,79 @@ int main(int argc, char* argv[])
     TCLAP::SwitchArg use_rdb("r", "rdb", "use older raster data block", false);
     TCLAP::SwitchArg keep_raw("k", "keep", "keep intermediate raw file "
                                           "during test data generation", false);
+    TCLAP::SwitchArg direct("", "direct", "brick the generated data directly "
+                            "without writing an intermediate raw file", false);
+    TCLAP::SwitchArg brick_checksums("", "brick-checksums", "store a "
+                                     "checksum for every brick, so damage "
+                                     "can be located with --verify-bricks",
+                                     false);
+    TCLAP::SwitchArg store_statistics("", "store-statistics", "store the "
+                                      "mean, standard deviation, "
+                                      "percentiles and zero fraction of "
+                                      "the data in the file", false);
+    TCLAP::SwitchArg statistics("", "statistics", "print the mean, "
+                                "standard deviation, percentiles and zero "
+                                "fraction of the data, computed in "
+                                "parallel unless the file stores them",
+                                false);
+    TCLAP::SwitchArg headers("", "headers", "only list the block headers, "
+                             "no block is loaded and the checksum is not "
+                             "tested", false);
+    TCLAP::SwitchArg compare("", "compare", "compare the volumes of two "
+                             "files voxel by voxel at the finest level of "
+                             "detail, brick sizes and compression may "
+                             "differ", false);
+    TCLAP::ValueArg<uint64_t> comparediffs("", "compare-diffs", "number of "
+                                           "differing values to list",
+                                           false, static_cast<uint64_t>(10),
+                                           uint);
+    TCLAP::SwitchArg scan_bricks("", "scan-bricks", "decode all bricks to "
+                                 "count empty and constant bricks per level "
+                                 "of detail", false);
+    TCLAP::SwitchArg benchmark("", "benchmark", "measure how fast the "
+                               "bricks of one level of detail load, with a "
+                               "cold and a warm file cache", false);
+    TCLAP::ValueArg<uint64_t> benchlod("", "bench-lod", "level of detail to "
+                                       "benchmark, 0 is the finest", false,
+                                       static_cast<uint64_t>(0), uint);
+    TCLAP::ValueArg<uint64_t> benchsample("", "bench-sample", "number of "
+                                          "randomly chosen bricks to load "
+                                          "(see --seed), 0: all bricks",
+                                          false, static_cast<uint64_t>(0),
+                                          uint);
+    TCLAP::SwitchArg simulate("", "simulate", "replay synthetic renderer "
+                              "access patterns (frustum sweep, slice "
+                              "scrolling, LoD refinement) to compare brick "
+                              "layouts", false);
+    TCLAP::ValueArg<uint64_t> simlod("", "sim-lod", "finest level of detail "
+                                     "the access patterns request, 0 is the "
+                                     "finest", false,
+                                     static_cast<uint64_t>(0), uint);
+    TCLAP::ValueArg<uint64_t> simviews("", "sim-views", "number of camera "
+                                       "positions of the frustum sweep",
+                                       false, static_cast<uint64_t>(8), uint);
+    TCLAP::SwitchArg noreplay("", "no-replay", "only compute the seek "
+                              "statistics of the access patterns, do not "
+                              "load the bricks", false);
+    TCLAP::ValueArg<std::string> dump("", "dump", "write the voxels of the "
+                                      "volume to this file, - for stdout",
+                                      false, "", "filename");
+    TCLAP::ValueArg<uint64_t> dumplod("", "dump-lod", "level of detail to "
+                                      "write, 0 is the finest", false,
+                                      static_cast<uint64_t>(0), uint);
+    TCLAP::ValueArg<std::string> dumpregion("", "dump-region", "part of the "
+                                            "level of detail to write, a "
+                                            "size of 0 extends to the end",
+                                            false, "0,0,0,0,0,0",
+                                            "x,y,z,width,height,depth");
+    TCLAP::SwitchArg dumpraw("", "dump-raw", "write binary voxels instead "
+                             "of text", false);
+    TCLAP::ValueArg<std::string> format("", "format", "report format when "
+                                        "reading files: text, json or csv",
+                                        false, "text", "format");
+    TCLAP::SwitchArg verify_bricks("", "verify-bricks", "verify the brick "
+                                   "checksums in parallel and list the "
+                                   "damaged bricks", false);
 
     cmd.add(inputs);
     cmd.add(noverify);
@@ -117,36 +258,68 @@ int main(int argc, char* argv[])
     cmd.add(hist2d);
     cmd.add(create);
     cmd.add(hierarchical);
+    cmd.add(fastfractal);
     cmd.add(compression);
     cmd.add(complevel);
     cmd.add(ctype);
     cmd.add(mem);
+    cmd.add(jobs);
     cmd.add(iter);
+    cmd.add(seed);
+    cmd.add(frequency);
+    cmd.add(sparsity);
     cmd.add(keep_raw);
+    cmd.add(direct);
+    cmd.add(brick_checksums);
+    cmd.add(store_statistics);
+    cmd.add(statistics);
+    cmd.add(headers);
+    cmd.add(compare);
+    cmd.add(comparediffs);
+    cmd.add(verify_bricks);
+    cmd.add(format);
+    cmd.add(scan_bricks);
+    cmd.add(benchmark);
+    cmd.add(benchlod);
+    cmd.add(benchsample);
+    cmd.add(simulate);
+    cmd.add(simlod);
+    cmd.add(simviews);
+    cmd.add(noreplay);
+    cmd.add(dump);
+    cmd.add(dumplod);
+    cmd.add(dumpregion);
+    cmd.add(dumpraw);
     cmd.add(sizeX);
     cmd.add(sizeY);
     cmd.add(sizeZ);
     cmd.add(bits);
+    cmd.add(floatdata);
     cmd.add(bsize);
     cmd.add(blayout);
     cmd.add(use_rdb);
     cmd.add(output_data);
     cmd.parse(argc, argv);
 
-    /// @todo FIXME support a list of filenames and process them in sequence.
-    strUVFName = inputs.getValue()[0];
+    vUVFNames = inputs.getValue();
     iSizeX = static_cast<uint32_t>(sizeX.getValue());
     iSizeY = static_cast<uint32_t>(sizeY.getValue());
     iSizeZ = static_cast<uint32_t>(sizeZ.getValue());
     iBitSize = static_cast<uint32_t>(bits.getValue());
+    bFloat = floatdata.getValue();
     iBrickSize = static_cast<uint32_t>(bsize.getValue());
     iIter = static_cast<uint32_t>(iter.getValue());
+    iSeed = seed.getValue();
+    fFrequency = frequency.getValue();
+    fSparsity = sparsity.getValue();
     iMem = static_cast<uint32_t>(mem.getValue());
+    iJobs = static_cast<uint32_t>(jobs.getValue());
     iBrickLayout = static_cast<uint32_t>(blayout.getValue());
     iCompression = static_cast<uint32_t>(compression.getValue());
     iCompressionLevel = static_cast<uint32_t>(complevel.getValue());
 
     bhierarchical = hierarchical.getValue();
+    bFastFractal = fastfractal.getValue();
     bCreateFile = create.getValue();
     bVerify = !noverify.getValue();
     bShow1dhist = hist1d.getValue();
@@ -155,33 +328,147 @@ int main(int argc, char* argv[])
     bShowData = output_data.getValue();
     bUseToCBlock = !use_rdb.getValue();
     bKeepRaw = keep_raw.getValue();
+    bDirectToBrick = direct.getValue();
+    bBrickChecksums = brick_checksums.getValue();
+    bStoreStatistics = store_statistics.getValue();
+    bStatistics = statistics.getValue();
+    bHeaders = headers.getValue();
+    bCompare = compare.getValue();
+    iCompareDiffs = comparediffs.getValue();
+    bVerifyBricks = verify_bricks.getValue();
+    bScanBricks = scan_bricks.getValue();
+    bBenchmark = benchmark.getValue();
+    iBenchLoD = benchlod.getValue();
+    iBenchSample = benchsample.getValue();
+    bSimulate = simulate.getValue();
+    iSimLoD = simlod.getValue();
+    iSimViews = simviews.getValue();
+    bReplay = !noreplay.getValue();
+    strDumpTarget = dump.getValue();
+    iDumpLoD = dumplod.getValue();
+    bDumpRaw = dumpraw.getValue();
+    if (!ParseDumpRegion(dumpregion.getValue(), dumpRegion)) {
+      std::cerr << "error: invalid region " << dumpregion.getValue()
+                << ", use x,y,z,width,height,depth\n";
+      return EXIT_FAILURE_ARG;
+    }
+
+    const std::string strFormat = SysTools::ToLowerCase(format.getValue());
+    if (strFormat == "json") {
+      eReportFormat = RF_JSON;
+    } else if (strFormat == "csv") {
+      eReportFormat = RF_CSV;
+    } else if (strFormat != "text") {
+      std::cerr << "error: unknown report format " << format.getValue()
+                << ", use text, json or csv\n";
+      return EXIT_FAILURE_ARG;
+    }
   } catch(const TCLAP::ArgException& e) {
     std::cerr << "error: " << e.error() << " for arg " << e.argId() << "\n";
-    return EXIT_FAILURE;
+    return EXIT_FAILURE_ARG;
   }
 
   UINT64VECTOR3 vSize(iSizeX, iSizeY, iSizeZ);
 
-  if (strUVFName.empty()) {
-    cerr << endl << "Missing Argument -f or filename was empty" << endl;
-    return EXIT_FAILURE;
+  for (size_t i = 0;i<vUVFNames.size();i++) {
+    if (vUVFNames[i].empty()) {
+      cerr << endl << "Missing Argument -f or filename was empty" << endl;
+      return EXIT_FAILURE_ARG;
+    }
+  }
+
+  if (bFloat ? (iBitSize != 16 && iBitSize != 32 && iBitSize != 64)
+             : (iBitSize != 8 && iBitSize != 16 && iBitSize != 32)) {
+    cerr << endl << "Argument -bits can only be 8, 16 or 32 for integer and "
+                    "16, 32 or 64 for float data" << endl;
+    return EXIT_FAILURE_ARG;
   }
 
-  if (iBitSize != 8 && iBitSize != 16) {
-    cerr << endl << "Argument -bits can only be 8 or 16" << endl;
-    return EXIT_FAILURE;
+  if (eCreationType > CT_GRADIENT) {
+    cerr << endl << "Argument -t must be between 0 and "
+         << int(CT_GRADIENT) << endl;
+    return EXIT_FAILURE_ARG;
+  }
+
+  if (fFrequency <= 0.0 || fSparsity < 0.0 || fSparsity >= 1.0) {
+    cerr << endl << "Argument --frequency must be positive and --sparsity "
+                    "must be in [0, 1)" << endl;
+    return EXIT_FAILURE_ARG;
   }
 
   if (iCompression && !bUseToCBlock) {
     cerr << endl << "Brick compression is not available with the "
                     "old file format (-r switch)" << endl;
-    return EXIT_FAILURE;
+    return EXIT_FAILURE_ARG;
   }
 
   if (iIter && (!bCreateFile || !eCreationType == CT_FRACTAL)) {
     cerr << endl << "Iteration count only valid when computing a mandelbuld "
                     "fractal in file creation mode" << endl;
-    return EXIT_FAILURE;
+    return EXIT_FAILURE_ARG;
+  }
+
+  if (bBrickChecksums && (!bCreateFile || !bUseToCBlock)) {
+    cerr << endl << "Brick checksums (--brick-checksums) can only be stored "
+                    "when creating a UVF file with the TOC block" << endl;
+    return EXIT_FAILURE_ARG;
+  }
+
+  if (bStoreStatistics && (!bCreateFile || !bUseToCBlock)) {
+    cerr << endl << "Statistics (--store-statistics) can only be stored "
+                    "when creating a UVF file with the TOC block" << endl;
+    return EXIT_FAILURE_ARG;
+  }
+
+  if ((bVerifyBricks || bScanBricks || bBenchmark || bSimulate ||
+       bStatistics || bHeaders) && bCreateFile) {
+    cerr << endl << "Arguments --verify-bricks, --scan-bricks, --benchmark, "
+                    "--simulate, --statistics and --headers are only valid "
+                    "when reading files" << endl;
+    return EXIT_FAILURE_ARG;
+  }
+
+  if (int(bBenchmark) + int(bSimulate) + int(bStatistics) +
+      int(bHeaders) > 1) {
+    cerr << endl << "Arguments --benchmark, --simulate, --statistics and "
+                    "--headers cannot be combined" << endl;
+    return EXIT_FAILURE_ARG;
+  }
+
+  if (bCompare &&
+      (bCreateFile || bBenchmark || bSimulate || bStatistics || bHeaders ||
+       !strDumpTarget.empty() || vUVFNames.size() != 2)) {
+    cerr << endl << "Argument --compare needs exactly two files to read and "
+                    "cannot be combined with other modes" << endl;
+    return EXIT_FAILURE_ARG;
+  }
+
+  if (!strDumpTarget.empty() &&
+      (bCreateFile || bBenchmark || bSimulate || bStatistics || bHeaders ||
+       vUVFNames.size() != 1)) {
+    cerr << endl << "Argument --dump needs exactly one file to read and "
+                    "cannot be combined with -c, --benchmark, --simulate, "
+                    "--statistics or --headers" << endl;
+    return EXIT_FAILURE_ARG;
+  }
+
+  for (size_t i = 0;i<vUVFNames.size();i++) {
+    const bool bUVF =
+      SysTools::ToLowerCase(SysTools::GetExt(vUVFNames[i])) == "uvf";
+
+    if (bCreateFile && bFloat && iBitSize == 16 && bUVF) {
+      cerr << endl << "Half float data can only be written to a raw file, "
+                      "UVF has no 16 bit float brick type" << endl;
+      return EXIT_FAILURE_ARG;
+    }
+
+    if (bDirectToBrick && (!bCreateFile || !bUseToCBlock || bKeepRaw ||
+                           bhierarchical || !bUVF)) {
+      cerr << endl << "Direct brick generation (--direct) is only available "
+                      "when creating a UVF file with the TOC block and cannot "
+                      "be combined with -k or -g" << endl;
+      return EXIT_FAILURE_ARG;
+    }
   }
 
   if (bCreateFile) {
@@ -191,14 +478,139 @@ int main(int argc, char* argv[])
     MESSAGE("Using up to %u GB RAM", iMem);
     cout << endl;
 
-    if (!CreateUVFFile(strUVFName, vSize, iBitSize, eCreationType, iIter,
-                       bUseToCBlock, bKeepRaw, iCompression, iMem, iBrickSize,
-                       iBrickLayout, iCompressionLevel, bhierarchical))
-      return EXIT_FAILURE;
+    // every file uses all cores already, so they are created in sequence
+    const GeneratorParams params = {iIter, 0, iSeed, fFrequency, fSparsity};
+    for (size_t i = 0;i<vUVFNames.size();i++) {
+      if (!CreateUVFFile(vUVFNames[i], vSize, iBitSize, bFloat, eCreationType,
+                         params, bUseToCBlock, bKeepRaw, iCompression, iMem,
+                         iBrickSize, iBrickLayout, iCompressionLevel,
+                         bhierarchical, bFastFractal, bDirectToBrick,
+                         bBrickChecksums, bStoreStatistics))
+        return EXIT_FAILURE_CREATE;
+    }
+  } else if (bCompare) {
+    if (eReportFormat != RF_TEXT)
+      debugOut->SetOutput(true, true, false, false);
+    CompareResult result;
+    std::string strProblem;
+    if (!CompareVolumes(vUVFNames[0], vUVFNames[1], size_t(iCompareDiffs),
+                        WorkerCount(iJobs), result, strProblem)) {
+      cerr << endl << "Unable to compare " << vUVFNames[0] << " and "
+           << vUVFNames[1] << "!" << endl << "Error: " << strProblem << endl;
+      return EXIT_FAILURE_READ_ALL;
+    }
+    if (eReportFormat == RF_TEXT) {
+      PrintComparison(vUVFNames[0], vUVFNames[1], result, cout);
+    } else {
+      ReportWriter r(cout, eReportFormat);
+      if (eReportFormat == RF_CSV) cout << ReportWriter::CSVHeader();
+      ReportComparison(vUVFNames[0], vUVFNames[1], result, r);
+    }
+    if (result.iDifferentValues > 0) return EXIT_FAILURE_DIFFERENT;
+  } else if (!strDumpTarget.empty()) {
+    // keep stdout clean when the data goes there
+    if (strDumpTarget == "-") debugOut->SetOutput(true, true, false, false);
+    std::string strProblem;
+    if (!DumpVolume(vUVFNames[0], iDumpLoD, dumpRegion,
+                    bDumpRaw ? DF_RAW : DF_TEXT, strDumpTarget,
+                    strProblem)) {
+      cerr << endl << "Unable to write the data of " << vUVFNames[0] << "!"
+           << endl << "Error: " << strProblem << endl;
+      return EXIT_FAILURE_READ_ALL;
+    }
+  } else if (bBenchmark || bSimulate || bStatistics || bHeaders) {
+    // the files are measured one after the other, so they do not compete
+    // for the disk
+    if (eReportFormat != RF_TEXT)
+      debugOut->SetOutput(true, true, false, false);
+    ReportWriter r(cout, eReportFormat);
+    if (eReportFormat == RF_CSV) cout << ReportWriter::CSVHeader();
+    if (eReportFormat == RF_JSON && vUVFNames.size() > 1) cout << "[\n";
+
+    size_t iFailed = 0;
+    size_t iWritten = 0;
+    for (size_t i = 0;i<vUVFNames.size();i++) {
+      BenchmarkResult result;
+      AccessSimulation sim;
+      std::vector<ValueStatistics> vStats;
+      bool bStored = false;
+      UVFHeaderListing listing;
+      std::string strProblem;
+      bool bOK;
+      if (bBenchmark)
+        bOK = BenchmarkBricks(vUVFNames[i], iBenchLoD, iBenchSample, iSeed,
+                              WorkerCount(iJobs), result, strProblem);
+      else if (bSimulate)
+        bOK = SimulateAccessPatterns(vUVFNames[i], iSimLoD, iSimViews,
+                                     bReplay, sim, strProblem);
+      else if (bStatistics)
+        bOK = VolumeStatistics(vUVFNames[i], WorkerCount(iJobs), vStats,
+                               bStored, strProblem);
+      else
+        bOK = ReadUVFHeaders(vUVFNames[i], listing, strProblem);
+      if (!bOK) {
+        cerr << endl << "Analysis of " << vUVFNames[i] << " failed!" << endl
+             << "Error: " << strProblem << endl;
+        iFailed++;
+        continue;
+      }
+      if (eReportFormat == RF_TEXT) {
+        if (bBenchmark)
+          PrintBenchmark(vUVFNames[i], result, cout);
+        else if (bSimulate)
+          PrintAccessSimulation(vUVFNames[i], sim, cout);
+        else if (bStatistics)
+          PrintStatistics(vUVFNames[i], vStats, bStored, cout);
+        else
+          PrintUVFHeaders(vUVFNames[i], listing, cout);
+      } else {
+        if (eReportFormat == RF_JSON && iWritten > 0) cout << ",\n";
+        if (bBenchmark)
+          ReportBenchmark(vUVFNames[i], result, r);
+        else if (bSimulate)
+          ReportAccessSimulation(vUVFNames[i], sim, r);
+        else if (bStatistics)
+          ReportStatistics(vUVFNames[i], vStats, bStored, r);
+        else
+          ReportUVFHeaders(vUVFNames[i], listing, r);
+        r.Flush();
+        iWritten++;
+      }
+    }
+    if (eReportFormat == RF_JSON && vUVFNames.size() > 1) cout << "]\n";
+
+    if (iFailed == vUVFNames.size()) return EXIT_FAILURE_READ_ALL;
+    if (iFailed > 0) return EXIT_FAILURE_READ;
+  } else if (vUVFNames.size() == 1 && eReportFormat != RF_TEXT) {
+    // keep stdout parseable, only warnings and errors are shown
+    debugOut->SetOutput(true, true, false, false);
+    ReportWriter r(cout, eReportFormat);
+    if (eReportFormat == RF_CSV) cout << ReportWriter::CSVHeader();
+    if (!ReportUVFInfo(vUVFNames[0], bVerify, bShow1dhist, bShow2dhist,
+                       bVerifyBricks, bScanBricks, r))
+      return EXIT_FAILURE_READ_ALL;
+  } else if (vUVFNames.size() == 1) {
+    if (!DisplayUVFInfo(vUVFNames[0], bVerify, bShowData, bShow1dhist,
+                        bShow2dhist, bVerifyBricks, bScanBricks))
+      return EXIT_FAILURE_READ_ALL;
   } else {
-    if (!DisplayUVFInfo(strUVFName, bVerify, bShowData, bShow1dhist, 
-                        bShow2dhist))
-      return EXIT_FAILURE;
+    // progress messages of concurrent checksum tests would garble the
+    // reports, only warnings and errors are shown
+    debugOut->SetOutput(true, true, false, false);
+    const vector<string> vFailed = DisplayUVFInfo(vUVFNames,
+                                                  WorkerCount(iJobs), bVerify,
+                                                  bShowData, bShow1dhist,
+                                                  bShow2dhist, bVerifyBricks,
+                                                  bScanBricks, eReportFormat);
+    // the summary must not end up in a JSON or CSV report
+    std::ostream& summary = eReportFormat == RF_TEXT ? cout : cerr;
+    summary << "Processed " << vUVFNames.size() << " files, "
+            << vFailed.size() << " failed" << endl;
+    for (size_t i = 0;i<vFailed.size();i++)
+      summary << "FAILED: " << vFailed[i] << endl;
+
+    if (vFailed.size() == vUVFNames.size()) return EXIT_FAILURE_READ_ALL;
+    if (!vFailed.empty()) return EXIT_FAILURE_READ;
   }
 
   return EXIT_SUCCESS;